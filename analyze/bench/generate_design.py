@@ -0,0 +1,124 @@
+"""Generates a synthetic design for the analyze benchmark.
+
+The design is a tree of parameterized modules: every module of level L
+instantiates FANOUT modules of level L+1, down to DEPTH levels, and the
+leaves are Verilog modules or VHDL entities. Instances cycle through
+VARIANTS values of the VARIANT parameter, so each level has up to VARIANTS
+module variants in hier_info.json. An analyze.cmd is written next to the sources.
+"""
+import argparse
+import os
+
+
+def verilog_node(level, depth, fanout, variants, width, signals, vhdl_leaves):
+    child = "node_%d" % (level + 1) if level + 1 < depth else "leaf"
+    lines = []
+    lines.append("module node_%d #(parameter WIDTH = %d, parameter VARIANT = 0) (" % (level, width))
+    lines.append("    input  wire clk,")
+    lines.append("    input  wire [WIDTH-1:0] din,")
+    lines.append("    output wire [WIDTH-1:0] dout")
+    lines.append(");")
+    for s in range(signals):
+        lines.append("    reg [WIDTH-1:0] state_%d;" % s)
+    lines.append("    wire [WIDTH-1:0] chain [0:%d];" % fanout)
+    lines.append("    assign chain[0] = din ^ VARIANT;")
+    for i in range(fanout):
+        variant = i % variants
+        # Leaves alternate between the Verilog and the VHDL implementation
+        name = child
+        if child == "leaf":
+            name = "leaf_vhdl" if vhdl_leaves and i % 2 else "leaf_v"
+        lines.append("    %s #(.WIDTH(WIDTH), .VARIANT(%d)) u_%d (.clk(clk), .din(chain[%d]), .dout(chain[%d]));"
+                     % (name, variant, i, i, i + 1))
+    for s in range(signals):
+        lines.append("    always @(posedge clk) state_%d <= chain[%d];" % (s, s % (fanout + 1)))
+    lines.append("    assign dout = chain[%d];" % fanout)
+    lines.append("endmodule")
+    return "\n".join(lines) + "\n"
+
+
+def verilog_leaf(width, signals):
+    lines = []
+    lines.append("module leaf_v #(parameter WIDTH = %d, parameter VARIANT = 0) (" % width)
+    lines.append("    input  wire clk,")
+    lines.append("    input  wire [WIDTH-1:0] din,")
+    lines.append("    output reg  [WIDTH-1:0] dout")
+    lines.append(");")
+    for s in range(signals):
+        lines.append("    wire [WIDTH-1:0] tmp_%d = din + %d + VARIANT;" % (s, s))
+    lines.append("    always @(posedge clk) dout <= din;")
+    lines.append("endmodule")
+    return "\n".join(lines) + "\n"
+
+
+def vhdl_leaf(width, signals):
+    lines = []
+    lines.append("library ieee;")
+    lines.append("use ieee.std_logic_1164.all;")
+    lines.append("")
+    lines.append("entity leaf_vhdl is")
+    lines.append("    generic (WIDTH : integer := %d; VARIANT : integer := 0);" % width)
+    lines.append("    port (")
+    lines.append("        clk  : in  std_logic;")
+    lines.append("        din  : in  std_logic_vector(WIDTH-1 downto 0);")
+    lines.append("        dout : out std_logic_vector(WIDTH-1 downto 0)")
+    lines.append("    );")
+    lines.append("end entity;")
+    lines.append("")
+    lines.append("architecture rtl of leaf_vhdl is")
+    for s in range(signals):
+        lines.append("    signal tmp_%d : std_logic_vector(WIDTH-1 downto 0);" % s)
+    lines.append("begin")
+    lines.append("    process (clk) begin")
+    lines.append("        if rising_edge(clk) then")
+    lines.append("            dout <= din;")
+    lines.append("        end if;")
+    lines.append("    end process;")
+    lines.append("end architecture;")
+    return "\n".join(lines) + "\n"
+
+
+def generate(out_dir, depth, fanout, variants, width, signals, vhdl, extra_options=()):
+    os.makedirs(os.path.join(out_dir, "rtl"), exist_ok=True)
+    verilog_files = []
+    for level in range(depth):
+        path = os.path.join("rtl", "node_%d.v" % level)
+        with open(os.path.join(out_dir, path), "w") as f:
+            f.write(verilog_node(level, depth, fanout, variants, width, signals, vhdl))
+        verilog_files.append(path)
+    path = os.path.join("rtl", "leaf_v.v")
+    with open(os.path.join(out_dir, path), "w") as f:
+        f.write(verilog_leaf(width, signals))
+    verilog_files.append(path)
+
+    cmd = []
+    if vhdl:
+        path = os.path.join("rtl", "leaf_vhdl.vhd")
+        with open(os.path.join(out_dir, path), "w") as f:
+            f.write(vhdl_leaf(width, signals))
+        cmd.append("-vhdl2008 " + path)
+    cmd.append("-sv " + " ".join(verilog_files))
+    cmd.append("-top node_0")
+    cmd.extend(extra_options)
+    with open(os.path.join(out_dir, "analyze.cmd"), "w") as f:
+        f.write("\n".join(cmd) + "\n")
+    return fanout ** depth
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generates a synthetic design for the analyze benchmark.")
+    parser.add_argument("out_dir", help="directory receiving rtl/ and analyze.cmd")
+    parser.add_argument("--depth", type=int, default=4, help="levels of hierarchy")
+    parser.add_argument("--fanout", type=int, default=4, help="instances per module")
+    parser.add_argument("--variants", type=int, default=2, help="parameter variants per level")
+    parser.add_argument("--width", type=int, default=16, help="port width")
+    parser.add_argument("--signals", type=int, default=8, help="internal signals per module")
+    parser.add_argument("--no-vhdl", action="store_true", help="Verilog leaves only")
+    args = parser.parse_args()
+    leaves = generate(args.out_dir, args.depth, args.fanout, args.variants, args.width,
+                      args.signals, not args.no_vhdl)
+    print("Generated %s with %d leaf instances" % (args.out_dir, leaves))
+
+
+if __name__ == "__main__":
+    main()
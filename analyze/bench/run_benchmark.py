@@ -0,0 +1,140 @@
+"""Times analyze on synthetic designs of increasing size.
+
+Each design is generated with generate_design.py and analyzed --repeat
+times with -profile. The median wall time of the whole run and of each
+phase of analyze_profile.json, and the peak memory, are written to a JSON
+file. Given a previous result file with --baseline, the differences are
+printed as well.
+"""
+import argparse
+import json
+import os
+import platform
+import shutil
+import statistics
+import subprocess
+import sys
+import time
+
+from generate_design import generate
+
+# name: (depth, fanout, variants, width, signals, vhdl)
+DESIGNS = {
+    "small":  (3, 4, 2, 16, 8, True),
+    "medium": (5, 4, 3, 32, 16, True),
+    "large":  (6, 5, 4, 64, 32, True),
+    "wide":   (2, 64, 8, 128, 64, False),
+    "deep":   (12, 2, 2, 16, 8, True),
+}
+
+
+def run_analyze(analyze, work_dir):
+    start = time.monotonic()
+    res = subprocess.run([analyze, "-f", "analyze.cmd"], cwd=work_dir,
+                         stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    wall = time.monotonic() - start
+    if res.returncode != 0:
+        print(res.stdout)
+        raise RuntimeError("analyze failed on %s" % work_dir)
+    with open(os.path.join(work_dir, "analyze_profile.json")) as f:
+        profile = json.load(f)
+    return wall, profile
+
+
+def phase_name(phase):
+    if "library" in phase:
+        return "%s (%s)" % (phase["phase"], phase["library"])
+    return phase["phase"]
+
+
+def bench_design(analyze, work_dir, name, config, repeat, options):
+    design_dir = os.path.join(work_dir, name)
+    shutil.rmtree(design_dir, ignore_errors=True)
+    depth, fanout, variants, width, signals, vhdl = config
+    leaves = generate(design_dir, depth, fanout, variants, width, signals, vhdl,
+                      ["-profile"] + options)
+    walls = []
+    phases = {}
+    peak = 0
+    for _ in range(repeat):
+        wall, profile = run_analyze(analyze, design_dir)
+        walls.append(wall)
+        peak = max(peak, profile["total"]["peakRssKb"])
+        for phase in profile["phases"]:
+            phases.setdefault(phase_name(phase), []).append(phase["wallSeconds"])
+    sizes = {}
+    for output in sorted(os.listdir(design_dir)):
+        if output.startswith(("port_info", "hier_info")):
+            sizes[output] = os.path.getsize(os.path.join(design_dir, output))
+    return {
+        "design": name,
+        "config": {"depth": depth, "fanout": fanout, "variants": variants, "width": width,
+                   "signals": signals, "vhdl": vhdl, "leafInstances": leaves},
+        "wallSeconds": statistics.median(walls),
+        "runs": walls,
+        "phases": {phase: statistics.median(times) for phase, times in sorted(phases.items())},
+        "peakRssKb": peak,
+        "outputBytes": sizes,
+    }
+
+
+def compare(results, baseline):
+    previous = {r["design"]: r for r in baseline["results"]}
+
+    def change(old, new):
+        return "%+.1f%%" % (100.0 * (new - old) / old) if old > 0 else "n/a"
+
+    for result in results["results"]:
+        old = previous.get(result["design"])
+        if not old:
+            continue
+        print("%-8s total %8.3f s -> %8.3f s  %s" % (result["design"], old["wallSeconds"],
+              result["wallSeconds"], change(old["wallSeconds"], result["wallSeconds"])))
+        for phase, seconds in result["phases"].items():
+            if phase in old["phases"]:
+                print("    %-40s %8.3f s -> %8.3f s  %s" % (phase, old["phases"][phase], seconds,
+                      change(old["phases"][phase], seconds)))
+        print("    %-40s %8d kB -> %8d kB  %s" % ("peak memory", old["peakRssKb"], result["peakRssKb"],
+              change(old["peakRssKb"], result["peakRssKb"])))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Times analyze on synthetic designs.")
+    parser.add_argument("--analyze", required=True, help="analyze executable")
+    parser.add_argument("--work-dir", default="analyze_bench", help="directory for the generated designs")
+    parser.add_argument("--output", default="analyze_bench.json", help="result file")
+    parser.add_argument("--baseline", help="result file of a previous run to compare with")
+    parser.add_argument("--designs", default="small,medium,large,wide,deep",
+                        help="comma separated list among " + ",".join(DESIGNS))
+    parser.add_argument("--repeat", type=int, default=3, help="runs per design, the median is kept")
+    parser.add_argument("--option", action="append", default=[],
+                        help="extra instruction added to every analyze.cmd, e.g. --option=-hier-dedup")
+    args = parser.parse_args()
+
+    analyze = os.path.abspath(args.analyze)
+    results = {
+        "analyze": analyze,
+        "host": platform.node(),
+        "date": time.strftime("%Y-%m-%dT%H:%M:%S"),
+        "options": args.option,
+        "results": [],
+    }
+    for name in args.designs.split(","):
+        if name not in DESIGNS:
+            sys.exit("Unknown design %s" % name)
+        result = bench_design(analyze, args.work_dir, name, DESIGNS[name], args.repeat, args.option)
+        print("%-8s %8.3f s  %8d kB" % (name, result["wallSeconds"], result["peakRssKb"]))
+        results["results"].append(result)
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=4, sort_keys=True)
+        f.write("\n")
+    print("Results written to %s" % args.output)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            compare(results, json.load(f))
+
+
+if __name__ == "__main__":
+    main()
@@ -10,11 +10,19 @@
 #include <string.h>
 #include <filesystem>
 #include <unordered_map>
+#include <map>
 #include <set>
 #include <vector>
+#include <functional>
+#include <memory>
+#include <chrono>
+#include <algorithm>
 #ifndef _WIN32
 #include <unistd.h>
 #include <limits.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <cerrno>
 #elif _WIN32
 #include <Windows.h>
 #include <limits>
@@ -23,6 +31,14 @@
 #include "ieee_1735.h"
 #include "port_dump.h"
 #include "hier_dump.h"
+#include "parse_cache.h"
+#include "analyze_server.h"
+#include "analyze_watch.h"
+#include "file_glob.h"
+#include "thread_pool.h"
+#include "content_hash.h"
+#include "output_reader.h"
+#include "profiler.h"
 #endif
 #ifdef PRODUCTION_BUILD
 #include "License_manager.hpp"
@@ -94,7 +110,12 @@ bool get_packages_path(const char* progName, fs::path& packages_path) {
 }
 
 void print_help() {
-    std::cout << "./analyze -f <path_to_instruction_file>\n\n";
+    std::cout << "./analyze -f <path_to_instruction_file>\n";
+    std::cout << "./analyze -server <socket> [-vhdl-preload {1987|1993|2008}]\n";
+    std::cout << "./analyze -connect <socket> -f <path_to_instruction_file>\n";
+    std::cout << "./analyze -watch -f <path_to_instruction_file> [-vhdl-preload {1987|1993|2008}]\n";
+    std::cout << "    any of the above can be given -vhdl-packages-shm\n";
+    std::cout << "./analyze -convert <input.{json|cbor|msgpack}> <output.{json|cbor|msgpack}>\n\n";
     std::cout << "The complete list of supported instructions:\n";
     std::cout << "{-vlog95|-vlog2k|-sv2005|-sv2009|-sv2012|-sv} [-D<macro>[=<value>]] <verilog-file/files>\n";
     std::cout << "{-vhdl87|-vhdl93|-vhdl2k|-vhdl2008|-vhdl} <vhdl-file/files>\n";
@@ -110,331 +131,1090 @@ void print_help() {
     std::cout << "-set-warning <msg_id/ids>\n";
     std::cout << "-set-info <msg_id/ids>\n";
     std::cout << "-set-ignore <msg_id/ids>\n";
+    std::cout << "-parse-cache <directory>\n";
+    std::cout << "-parse-cache-limit <MB>\n";
+    std::cout << "-compact-json\n";
+    std::cout << "-output-format {json|cbor|msgpack}\n";
+    std::cout << "-ports-only\n";
+    std::cout << "-hier-root <top.inst.path>\n";
+    std::cout << "-hier-depth <levels>\n";
+    std::cout << "-hier-dedup\n";
+    std::cout << "-hier-delta <digest-file>\n";
+    std::cout << "-hier-index\n";
+    std::cout << "-signals-include <regex>\n";
+    std::cout << "-signals-exclude <regex>\n";
+    std::cout << "-signals-max <count>\n";
+    std::cout << "-signals-skip-generated\n";
+    std::cout << "-profile\n";
+    std::cout << "-jobs <count>\n";
 }
+
+// An instruction file turned into the compilation units it describes and
+// the ordered list of steps to run them, interleaved with the global
+// Verific settings exactly as they appear in the file.
+struct analyzeStep {
+    int unit = -1;                  // index into analyzePlan::units
+    std::function<void()> apply;    // global setting when unit < 0
+};
+
+struct analyzePlan {
+    std::string top_module;
+    std::set<std::string> works;
+    std::vector<compileUnit> units;
+    std::vector<analyzeStep> steps;
+    fs::path cacheDir;
+    size_t cacheLimitMB = parseCache::defaultLimitMB;
+    outputFormat format = outputFormat::json;
+    bool portsOnly = false;
+    std::string hierRoot;
+    int hierDepth = -1;
+    bool hierDedup = false;
+    std::string hierDelta;
+    bool hierIndex = false;
+    hierDump::signalFilter signals;
+    bool profile = false;
+    int jobs = 1;
+};
+
 // ------------------------------
-// main
+// isLegacyWildcard
 // ------------------------------
-int main (int argc, char* argv[]) {
-
-    try {
-#ifdef PRODUCTION_BUILD
-        License_Manager license(License_Manager::LicensedProductName::ANALYZE);
-#endif
-        std::string top_module;
-        fs::path file_path;
-        std::set<std::string> works;
+// "dir/*.ext" and "*.ext" used to list the directory for every extension
+// of the language, whatever ext is. Kept for existing instruction files.
+static bool isLegacyWildcard(const std::string& arg) {
+    size_t star = arg.find("*.");
+    if (star == std::string::npos)
+        return false;
+    std::string dir = arg.substr(0, star);
+    std::string ext = arg.substr(star + 2);
+    return (dir.empty() || dir.back() == '/') && !fileGlob::isPattern(dir) &&
+        !fileGlob::isPattern(ext) && ext.find('/') == std::string::npos;
+}
 
-        if (argc < 3) {
-            print_help();
-            return 1;
+// ------------------------------
+// expandFiles
+// ------------------------------
+// The file list ending the line: files, patterns and "!pattern" exclusions,
+// which apply to all the patterns of the line
+static void expandFiles(const std::vector<std::string>& args, int argidx,
+        const std::set<std::string>& extensions, fileGlob& globs, std::vector<std::string>& files) {
+    std::vector<std::string> excludes;
+    for (int i = argidx; i < (int)args.size(); i++) {
+        if (args[i][0] == '!')
+            excludes.push_back(args[i].substr(1));
+    }
+    for (int i = argidx; i < (int)args.size(); i++) {
+        const std::string& arg = args[i];
+        if (arg[0] == '!')
+            continue;
+        // A file whose name holds pattern characters ("mem[0].v") is
+        // taken as it is
+        std::error_code ec;
+        if (!fileGlob::isPattern(arg) || fs::is_regular_file(arg, ec)) {
+            files.push_back(arg);
+            continue;
+        }
+        std::vector<std::string> matches;
+        if (isLegacyWildcard(arg)) {
+            // A bare "*.ext" listed the current directory by its absolute
+            // path, which ends up in the file IDs of the outputs
+            std::string dir = arg.substr(0, arg.find("*."));
+            for (auto& file : globs.expand(dir + "*", excludes))
+                if (extensions.count(fs::path(file).extension().string()))
+                    matches.push_back(dir.empty() ? (fs::current_path() / file).string() : file);
+        } else {
+            matches = globs.expand(arg, excludes);
         }
+        if (matches.empty())
+            std::cout << "WARNING: " << arg << " matches no file." << std::endl;
+        files.insert(files.end(), matches.begin(), matches.end());
+    }
+}
 
-        ieee_1735 protect;
-        veri_file::SetPragmaProtectObject(&protect);
+// ------------------------------
+// parseInstructions
+// ------------------------------
+static bool parseInstructions(std::istream& in, analyzePlan& plan) {
+    std::vector<std::string> verific_incdirs;
+    std::vector<std::string> verific_libdirs;
+    std::vector<std::string> verific_libexts;
+    std::vector<std::string> verific_libfiles;
+    std::vector<std::string> macro_ops;
+    std::vector<std::string> l_options;
+    fileGlob globs;
 
-        int argidx = 1;
-        bool dumpHierTree = true;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream buffer(line);
+        std::vector<std::string> args;
 
-        while (argidx < argc) {
-            if (std::string(argv[argidx]) == "-f") {
-                file_path = std::string(argv[++argidx]);
-                argidx++;
-                continue;
-            } else {
-                std::cout << "ERROR: Invalid option is specified. " << std::endl;
-                print_help();
-                return 1;
-            }
-        }
+        std::copy(std::istream_iterator<std::string>(buffer),
+                std::istream_iterator<std::string>(),
+                std::back_inserter(args));
 
-        std::ifstream in(file_path);
-        if (!in) {
-            std::cout << "ERROR: Could not open instruction file: " << file_path << std::endl;
-            return 1;
+        int size = args.size();
+        int argidx = 0;
+
+        if (size == 0 || args[argidx][0] == '#') {
+            continue;
         }
 
-        std::vector<std::string> verific_incdirs;
-        std::vector<std::string> verific_libdirs;
-        std::vector<std::string> verific_libexts;
-        std::vector<std::string> verific_libfiles;
+        while (argidx < size) { 
 
-        fs::path vhdl_packages;
-        if (!get_packages_path("analyze", vhdl_packages)) {
-            return 1;
-        }
+            std::string work = "work";
+            unsigned analysis_mode = veri_file::UNDEFINED;
 
-        std::string line;
-        while (std::getline(in, line)) {
-            std::istringstream buffer(line);
-            std::vector<std::string> args;
+            if (args[argidx] == "-set-error" || args[argidx] == "-set-warning" ||
+                    args[argidx] == "-set-info" || args[argidx] == "-set-ignore")
+            {
+                msg_type_t type;
 
-            std::copy(std::istream_iterator<std::string>(buffer),
-                    std::istream_iterator<std::string>(),
-                    std::back_inserter(args));
+                if (args[argidx] == "-set-error")
+                    type = VERIFIC_ERROR;
+                else if (args[argidx] == "-set-warning")
+                    type = VERIFIC_WARNING;
+                else if (args[argidx] == "-set-info")
+                    type = VERIFIC_INFO;
+                else
+                    type = VERIFIC_IGNORE;
 
-            int size = args.size();
-            int argidx = 0;
+                while (++argidx < size) {
+                    std::string id = args[argidx];
+                    plan.steps.push_back({-1, [id, type]() { Message::SetMessageType(id.c_str(), type); }});
+                }
 
-            if (size == 0 || args[argidx][0] == '#') {
                 continue;
             }
 
-            while (argidx < size) { 
-
-                std::string work = "work";
-                unsigned analysis_mode = veri_file::UNDEFINED;
+            if (args[argidx] == "-vlog-incdir") {
+                while (++argidx < size)
+                    verific_incdirs.push_back(args[argidx]);
+                continue;
+            }
 
-                if (args[argidx] == "-set-error" || args[argidx] == "-set-warning" ||
-                        args[argidx] == "-set-info" || args[argidx] == "-set-ignore")
-                {
-                    msg_type_t type;
+            if (args[argidx] == "-vlog-libdir") {
+                while (++argidx < size)
+                    verific_libdirs.push_back(args[argidx]);
+                continue;
+            }
 
-                    if (args[argidx] == "-set-error")
-                        type = VERIFIC_ERROR;
-                    else if (args[argidx] == "-set-warning")
-                        type = VERIFIC_WARNING;
-                    else if (args[argidx] == "-set-info")
-                        type = VERIFIC_INFO;
-                    else
-                        type = VERIFIC_IGNORE;
+            if (args[argidx] == "-vlog-libext") {
+                while (++argidx < size)
+                    verific_libexts.push_back(args[argidx]);
+                continue;
+            }
 
-                    while (++argidx < size)
-                        Message::SetMessageType(args[argidx].c_str(), type);
+            if (args[argidx] == "-v") {
+                while (++argidx < size)
+                    verific_libfiles.push_back(args[argidx]);
+                continue;
+            }
 
-                    continue;
+            if (args[argidx] == "-vlog-define") {
+                while (++argidx < size) {
+                    std::string name = args[argidx];
+                    macro_ops.push_back("+" + name);
+                    plan.steps.push_back({-1, [name]() {
+                        size_t equal = name.find('=');
+                        if (equal != std::string::npos) {
+                            std::string value = name.substr(equal+1);
+                            veri_file::DefineCmdLineMacro(name.substr(0, equal).c_str(), value.c_str());
+                        } else {
+                            veri_file::DefineCmdLineMacro(name.c_str());
+                        }
+                    }});
                 }
+                continue;
+            }
 
-                if (args[argidx] == "-vlog-incdir") {
-                    while (++argidx < size)
-                        verific_incdirs.push_back(args[argidx]);
-                    continue;
+            if (args[argidx] == "-vlog-undef") {
+                while (++argidx < size) {
+                    std::string name = args[argidx];
+                    macro_ops.push_back("-" + name);
+                    plan.steps.push_back({-1, [name]() { veri_file::UndefineMacro(name.c_str()); }});
                 }
+                continue;
+            }
 
-                if (args[argidx] == "-vlog-libdir") {
-                    while (++argidx < size)
-                        verific_libdirs.push_back(args[argidx]);
-                    continue;
+            if (args[argidx] == "-parse-cache") {
+                if (argidx + 1 >= size) {
+                    std::cout << "ERROR: -parse-cache expects a directory." << std::endl;
+                    return false;
                 }
+                plan.cacheDir = args[++argidx];
+                argidx++;
+                continue;
+            }
 
-                if (args[argidx] == "-vlog-libext") {
-                    while (++argidx < size)
-                        verific_libexts.push_back(args[argidx]);
-                    continue;
+            if (args[argidx] == "-parse-cache-limit") {
+                long limit = -1;
+                try {
+                    limit = argidx + 1 < size ? std::stol(args[argidx + 1]) : -1;
+                } catch (...) {
+                    limit = -1;
                 }
+                if (limit < 0) {
+                    std::cout << "ERROR: -parse-cache-limit expects a size in MB, 0 for no limit." << std::endl;
+                    return false;
+                }
+                plan.cacheLimitMB = limit;
+                argidx += 2;
+                continue;
+            }
 
-                if (args[argidx] == "-v") {
-                    while (++argidx < size)
-                        verific_libfiles.push_back(args[argidx]);
-                    continue;
+            if (args[argidx] == "-compact-json") {
+                plan.format = outputFormat::compactJson;
+                argidx++;
+                continue;
+            }
+
+            if (args[argidx] == "-profile") {
+                plan.profile = true;
+                argidx++;
+                continue;
+            }
+
+            if (args[argidx] == "-jobs") {
+                try {
+                    plan.jobs = argidx + 1 < size ? std::stoi(args[argidx + 1]) : 0;
+                } catch (...) {
+                    plan.jobs = 0;
                 }
+                if (plan.jobs < 1) {
+                    std::cout << "ERROR: -jobs expects a number of processes." << std::endl;
+                    return false;
+                }
+                argidx += 2;
+                continue;
+            }
 
-                if (args[argidx] == "-vlog-define") {
-                    while (++argidx < size) {
-                        std::string name = args[argidx];
-                        size_t equal = name.find('=');
-                        if (equal != std::string::npos) {
-                            std::string value = name.substr(equal+1);
-                            name = name.substr(0, equal);
-                            veri_file::DefineCmdLineMacro(name.c_str(), value.c_str());
-                        } else {
-                            veri_file::DefineCmdLineMacro(name.c_str());
-                        }
-                    }
-                    continue;
+            if (args[argidx] == "-ports-only") {
+                plan.portsOnly = true;
+                argidx++;
+                continue;
+            }
+
+            if (args[argidx] == "-hier-dedup") {
+                plan.hierDedup = true;
+                argidx++;
+                continue;
+            }
+
+            if (args[argidx] == "-signals-include" || args[argidx] == "-signals-exclude") {
+                if (argidx + 1 >= size) {
+                    std::cout << "ERROR: " << args[argidx] << " expects a regular expression." << std::endl;
+                    return false;
+                }
+                try {
+                    std::regex re(args[argidx + 1]);
+                    if (args[argidx] == "-signals-include")
+                        plan.signals.includes.push_back(re);
+                    else
+                        plan.signals.excludes.push_back(re);
+                } catch (const std::regex_error& e) {
+                    std::cout << "ERROR: Invalid regular expression " << args[argidx + 1] << ": " << e.what() << std::endl;
+                    return false;
                 }
+                argidx += 2;
+                continue;
+            }
 
-                if (args[argidx] == "-vlog-undef") {
-                    while (++argidx < size) {
-                        std::string name = args[argidx];
-                        veri_file::UndefineMacro(name.c_str());
-                    }
-                    continue;
+            if (args[argidx] == "-signals-max") {
+                try {
+                    plan.signals.maxCount = argidx + 1 < size ? std::stoi(args[argidx + 1]) : -1;
+                } catch (...) {
+                    plan.signals.maxCount = -1;
+                }
+                if (plan.signals.maxCount < 0) {
+                    std::cout << "ERROR: -signals-max expects a number of signals." << std::endl;
+                    return false;
                 }
+                argidx += 2;
+                continue;
+            }
 
-                if (argidx + 1 < size && args[argidx] == "-top") {
-                    top_module = args[++argidx];
-                    argidx++;
+            if (args[argidx] == "-signals-skip-generated") {
+                plan.signals.skipGenerated = true;
+                argidx++;
+                continue;
+            }
+
+            if (args[argidx] == "-hier-index") {
+                plan.hierIndex = true;
+                argidx++;
+                continue;
+            }
+
+            if (args[argidx] == "-hier-delta") {
+                if (argidx + 1 >= size) {
+                    std::cout << "ERROR: -hier-delta expects a digest file." << std::endl;
+                    return false;
                 }
+                plan.hierDelta = args[++argidx];
+                argidx++;
+                continue;
+            }
 
-                if (argidx + 1 < size && args[argidx] == "-work") {
-                    work = args[++argidx];
-                    argidx++;
+            if (args[argidx] == "-hier-root" || args[argidx] == "-hier-depth") {
+                if (argidx + 1 >= size) {
+                    std::cout << "ERROR: " << args[argidx] << " expects a value." << std::endl;
+                    return false;
+                }
+                if (args[argidx] == "-hier-root") {
+                    plan.hierRoot = args[argidx + 1];
+                } else {
+                    try {
+                        plan.hierDepth = std::stoi(args[argidx + 1]);
+                    } catch (...) {
+                        plan.hierDepth = -1;
+                    }
+                    if (plan.hierDepth < 0) {
+                        std::cout << "ERROR: -hier-depth expects a number of levels." << std::endl;
+                        return false;
+                    }
                 }
+                argidx += 2;
+                continue;
+            }
 
-                if (argidx + 1 < size && args[argidx] == "-L") {
-                    veri_file::AddLOption(args[++argidx].c_str());
-                    argidx++;
+            if (args[argidx] == "-output-format") {
+                std::string format = argidx + 1 < size ? args[argidx + 1] : "";
+                if (format == "json")
+                    plan.format = outputFormat::json;
+                else if (format == "cbor")
+                    plan.format = outputFormat::cbor;
+                else if (format == "msgpack")
+                    plan.format = outputFormat::msgpack;
+                else {
+                    std::cout << "ERROR: -output-format expects json, cbor or msgpack." << std::endl;
+                    return false;
                 }
+                argidx += 2;
+                continue;
+            }
 
-                if (argidx >= size)
-                    continue;
+            if (argidx + 1 < size && args[argidx] == "-top") {
+                plan.top_module = args[++argidx];
+                argidx++;
+            }
 
-                if (args[argidx] == "-vlog95") {
-                    analysis_mode = veri_file::VERILOG_95;
-                } else if (args[argidx] == "-vlog2k") {
-                    analysis_mode = veri_file::VERILOG_2K;
-                } else if (args[argidx] == "-sv2005") {
-                    analysis_mode = veri_file::SYSTEM_VERILOG_2005;
-                } else if (args[argidx] == "-sv2009") {
-                    analysis_mode = veri_file::SYSTEM_VERILOG_2009;
-                } else if (args[argidx] == "-sv2012" || args[argidx] == "-sv" || args[argidx] == "-formal") {
-                    analysis_mode = veri_file::SYSTEM_VERILOG;
-                }
+            if (argidx + 1 < size && args[argidx] == "-work") {
+                work = args[++argidx];
+                argidx++;
+            }
 
-                if(analysis_mode != veri_file::UNDEFINED) {
-                    Array file_names;
-                    argidx++;
+            if (argidx + 1 < size && args[argidx] == "-L") {
+                std::string option = args[++argidx];
+                l_options.push_back(option);
+                plan.steps.push_back({-1, [option]() { veri_file::AddLOption(option.c_str()); }});
+                argidx++;
+            }
 
-                    while(argidx < size && args[argidx].compare(0, 2, "-D") == 0) {
-                        std::string name = args[argidx].substr(2);
-                        size_t equal = name.find('=');
-                        if (equal != std::string::npos) {
-                            std::string value = name.substr(equal+1);
-                            name = name.substr(0, equal);
-                            veri_file::DefineMacro(name.c_str(), value.c_str());
-                        } else {
-                            veri_file::DefineMacro(name.c_str());
-                        }
-                        argidx++;
-                    }
+            if (argidx >= size)
+                continue;
 
-                    works.insert(work);
-                    while (argidx < size) {
-                        if (args[argidx].find("*.") != std::string::npos) {
-                            fs::path dir = fs::current_path();
-                            std::string file = args[argidx].substr(0, args[argidx].find("*."));
-                            if (!file.empty())
-                                dir = file;
-                            for (auto const& dir_entry : fs::directory_iterator{dir}) 
-                                if (dir_entry.path().extension() == ".v" || dir_entry.path().extension() == ".sv")
-                                    file_names.Insert(Strings::save(dir_entry.path().c_str()));
-                            argidx++;
-                        } else {
-                            file_names.Insert(Strings::save(args[argidx++].c_str()));
-                        }
-                    }
+            if (args[argidx] == "-vlog95") {
+                analysis_mode = veri_file::VERILOG_95;
+            } else if (args[argidx] == "-vlog2k") {
+                analysis_mode = veri_file::VERILOG_2K;
+            } else if (args[argidx] == "-sv2005") {
+                analysis_mode = veri_file::SYSTEM_VERILOG_2005;
+            } else if (args[argidx] == "-sv2009") {
+                analysis_mode = veri_file::SYSTEM_VERILOG_2009;
+            } else if (args[argidx] == "-sv2012" || args[argidx] == "-sv" || args[argidx] == "-formal") {
+                analysis_mode = veri_file::SYSTEM_VERILOG;
+            }
 
-                    for (auto &dir : verific_incdirs)
-                        veri_file::AddIncludeDir(dir.c_str());
-                    for (auto &dir : verific_libdirs)
-                        veri_file::AddYDir(dir.c_str());
-                    for (auto &ext : verific_libexts)
-                        veri_file::AddLibExt(ext.c_str());
-                    for (auto &ext : verific_libfiles) {
-                        veri_file::AnalyzeLibFile(ext.c_str(), veri_file::SYSTEM_VERILOG_2005, work.c_str());
-                    }
+            compileUnit unit;
+            unit.work = work;
+            unit.macroOps = macro_ops;
+            unit.lOptions = l_options;
 
-                    if (!veri_file::AnalyzeMultipleFiles(&file_names, analysis_mode, work.c_str(), veri_file::MFCU)) {
-                        std::cout << "ERROR: Reading Verilog/SystemVerilog sources failed.\n";
-                        return 1;
-                    }
+            if(analysis_mode != veri_file::UNDEFINED) {
+                argidx++;
 
-                    int i;
-                    char *f ;
-                    FOREACH_ARRAY_ITEM(&file_names, i, f) Strings::free(f); 
-                    continue;
+                while(argidx < size && args[argidx].compare(0, 2, "-D") == 0) {
+                    unit.defines.push_back(args[argidx].substr(2));
+                    argidx++;
                 }
 
-                if (args[argidx] == "-vhdl87") {
-                    analysis_mode = vhdl_file::VHDL_87;
-                    vhdl_file::SetDefaultLibraryPath((vhdl_packages / "vdbs_1987").c_str());
-                } else if (args[argidx] == "-vhdl93") {
-                    analysis_mode = vhdl_file::VHDL_93;
-                    vhdl_file::SetDefaultLibraryPath((vhdl_packages / "vdbs_1993").c_str());
-                } else if (args[argidx] == "-vhdl2k") {
-                    analysis_mode = vhdl_file::VHDL_2K;
-                    vhdl_file::SetDefaultLibraryPath((vhdl_packages / "vdbs_1993").c_str());
-                } else if (args[argidx] == "-vhdl2008" || args[argidx] == "-vhdl") {
-                    analysis_mode = vhdl_file::VHDL_2008;
-                    vhdl_file::SetDefaultLibraryPath((vhdl_packages / "vdbs_2008").c_str());
-                } else {
+                expandFiles(args, argidx, {".v", ".sv"}, globs, unit.files);
+                argidx = size;
+
+                unit.mode = analysis_mode;
+                unit.incdirs = verific_incdirs;
+                unit.libdirs = verific_libdirs;
+                unit.libexts = verific_libexts;
+                unit.libfiles = verific_libfiles;
+                plan.works.insert(work);
+                plan.steps.push_back({(int)plan.units.size(), nullptr});
+                plan.units.push_back(unit);
+                continue;
+            }
+
+            if (args[argidx] == "-vhdl87") {
+                analysis_mode = vhdl_file::VHDL_87;
+            } else if (args[argidx] == "-vhdl93") {
+                analysis_mode = vhdl_file::VHDL_93;
+            } else if (args[argidx] == "-vhdl2k") {
+                analysis_mode = vhdl_file::VHDL_2K;
+            } else if (args[argidx] == "-vhdl2008" || args[argidx] == "-vhdl") {
+                analysis_mode = vhdl_file::VHDL_2008;
+            } else {
 
-                    // Thierry : new code : we complain because we did not succeed to recognize
-                    // the option and we exit the infinite loop
-                    //
-                    std::cout << "ERROR: unrecognized option : " << args[argidx].c_str() << std::endl;
-                    return 1;
+                // Thierry : new code : we complain because we did not succeed to recognize
+                // the option and we exit the infinite loop
+                //
+                std::cout << "ERROR: unrecognized option : " << args[argidx].c_str() << std::endl;
+                return false;
 #if 0
-                    // Thierry : original code : we "continue" by returning to the starting point of
-                    // the loop and we are re-processing the same line on and on since we do not 
-                    // recognize the option "args[argidx]".
-                    //
-                    continue;
+                // Thierry : original code : we "continue" by returning to the starting point of
+                // the loop and we are re-processing the same line on and on since we do not 
+                // recognize the option "args[argidx]".
+                //
+                continue;
 #endif
-                }
+            }
 
-                if(analysis_mode != veri_file::UNDEFINED) {
-                    argidx++;
-                    works.insert(work);
-                    while (argidx < size) {
-                        if (args[argidx].find("*.") != std::string::npos) {
-                            fs::path dir = fs::current_path();
-                            std::string file = args[argidx].substr(0, args[argidx].find("*."));
-                            if (!file.empty())
-                                dir = file;
-                            for (auto const& dir_entry : fs::directory_iterator{dir}) 
-                                if (dir_entry.path().extension() == ".vhd")
-                                    if (!vhdl_file::Analyze(dir_entry.path().c_str(), work.c_str(), analysis_mode)) {
-                                        std::cout << "ERROR: Reading vhdl source failed:\n";
-                                        return 1;
-                                    }
-                            argidx++;
-                        } else {
-                            if (!vhdl_file::Analyze(args[argidx++].c_str(), work.c_str(), analysis_mode)) {
-                                std::cout << "ERROR: Reading vhdl source failed:\n";
-                                return 1;
-                            }
-                        }
-                    }
-                }
+            if(analysis_mode != veri_file::UNDEFINED) {
+                argidx++;
+                expandFiles(args, argidx, {".vhd"}, globs, unit.files);
+                argidx = size;
+
+                // Verilog macros and -L options do not reach VHDL analysis
+                unit.macroOps.clear();
+                unit.lOptions.clear();
+                unit.isVhdl = true;
+                unit.mode = analysis_mode;
+                plan.works.insert(work);
+                plan.steps.push_back({(int)plan.units.size(), nullptr});
+                plan.units.push_back(unit);
             }
         }
+    }
+
+    return true;
+}
+
+// Set when a server has the packages of one dialect loaded in memory
+static std::string residentVhdlPackages;
+
+// ------------------------------
+// vhdlPackagesDir
+// ------------------------------
+static std::string vhdlPackagesDir(unsigned mode) {
+    if (mode == vhdl_file::VHDL_87)
+        return "vdbs_1987";
+    if (mode == vhdl_file::VHDL_2008)
+        return "vdbs_2008";
+    return "vdbs_1993";
+}
+
+// ------------------------------
+// preloadVhdlPackages
+// ------------------------------
+static void preloadVhdlPackages(const fs::path& vhdl_packages, const std::string& vdbs) {
+    vhdl_file::SetDefaultLibraryPath((vhdl_packages / vdbs).c_str());
+    for (auto const& lib_entry : fs::directory_iterator{vhdl_packages / vdbs}) {
+        if (!lib_entry.is_directory())
+            continue;
+        VhdlLibrary *lib = vhdl_file::GetLibrary(lib_entry.path().filename().c_str(), 1);
+        for (auto const& unit_entry : fs::directory_iterator{lib_entry.path()})
+            if (unit_entry.path().extension() == ".vdb")
+                lib->GetPrimUnit(unit_entry.path().stem().c_str());
+    }
+    residentVhdlPackages = vdbs;
+}
 
-        verific_incdirs.clear();
-        verific_libdirs.clear();
-        verific_libexts.clear();
-
-        portDump *ports = new portDump("port_info.json");
-        hierDump *hierTree = new hierDump("hier_info.json");
-
-        for (auto &w : works) {
-            VeriLibrary *veri_lib = veri_file::GetLibrary(w.c_str(), 1);
-            VhdlLibrary *vhdl_lib = vhdl_file::GetLibrary(w.c_str(), 1);
-
-            Array *modules;
-            Array *units;
-            if (!top_module.empty()) {
-                Array m;
-                Array u;
-                VeriModule *veri_module = veri_lib ? veri_lib->GetModule(top_module.c_str(), 1) : nullptr;
-                if (veri_module) {
-                    m.InsertLast(veri_module);
+#ifndef _WIN32
+// ------------------------------
+// stageVhdlPackages
+// ------------------------------
+// Verific restores package units with its own file reads, it cannot be
+// handed a mapped image. Copying the package libraries to shared memory
+// once per installation gives every analyze process on the host the same
+// memory-resident files, whatever the installation is on (NFS, slow
+// disks). The copy is named by the installation path and the sizes and
+// dates of its files, and published with a rename so that concurrent
+// processes never see a partial copy.
+static fs::path stageVhdlPackages(const fs::path& vhdl_packages) {
+    fs::path shm = "/dev/shm";
+    if (!fs::is_directory(shm)) {
+        std::cout << "WARNING: No shared memory file system, VHDL packages are read from " << vhdl_packages << std::endl;
+        return vhdl_packages;
+    }
+
+    contentHash hash;
+    hash.add(fs::absolute(vhdl_packages).string());
+    std::vector<fs::path> files;
+    for (auto const& entry : fs::recursive_directory_iterator{vhdl_packages}) {
+        if (entry.is_regular_file())
+            files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    for (auto& file : files) {
+        hash.add(fs::relative(file, vhdl_packages).string());
+        hash.add(std::to_string(fs::file_size(file)));
+        hash.add(std::to_string(fs::last_write_time(file).time_since_epoch().count()));
+    }
+    fs::path staged = shm / ("analyze_vhdl_packages_" + hash.hex().substr(0, 16));
+    if (fs::is_directory(staged))
+        return staged;
+
+    fs::path tmp = staged.string() + ".tmp" + std::to_string(getpid());
+    std::error_code ec;
+    fs::copy(vhdl_packages, tmp, fs::copy_options::recursive, ec);
+    if (!ec)
+        fs::rename(tmp, staged, ec);
+    if (ec) {
+        std::error_code ignore;
+        fs::remove_all(tmp, ignore);
+        // Another process published it first
+        if (fs::is_directory(staged))
+            return staged;
+        std::cout << "WARNING: Could not copy VHDL packages to " << staged << ": " << ec.message() << std::endl;
+        return vhdl_packages;
+    }
+    std::cout << "INFO: VHDL packages copied to " << staged << std::endl;
+    return staged;
+}
+#endif
+
+// ------------------------------
+// prepareUnit
+// ------------------------------
+// Applies the settings a unit is analyzed with. These are also needed when
+// the unit is restored from the parse cache, elaboration depends on them.
+static void prepareUnit(const compileUnit& unit, const fs::path& vhdl_packages) {
+    if (unit.isVhdl) {
+        vhdl_file::SetDefaultLibraryPath((vhdl_packages / vhdlPackagesDir(unit.mode)).c_str());
+        return;
+    }
+
+    for (auto &define : unit.defines) {
+        size_t equal = define.find('=');
+        if (equal != std::string::npos) {
+            std::string value = define.substr(equal+1);
+            veri_file::DefineMacro(define.substr(0, equal).c_str(), value.c_str());
+        } else {
+            veri_file::DefineMacro(define.c_str());
+        }
+    }
+
+    for (auto &dir : unit.incdirs)
+        veri_file::AddIncludeDir(dir.c_str());
+    for (auto &dir : unit.libdirs)
+        veri_file::AddYDir(dir.c_str());
+    for (auto &ext : unit.libexts)
+        veri_file::AddLibExt(ext.c_str());
+}
+
+// ------------------------------
+// analyzeUnit
+// ------------------------------
+static bool analyzeUnit(const compileUnit& unit) {
+    if (unit.isVhdl) {
+        for (auto &file : unit.files) {
+            if (!vhdl_file::Analyze(file.c_str(), unit.work.c_str(), unit.mode)) {
+                std::cout << "ERROR: Reading vhdl source failed:\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    for (auto &ext : unit.libfiles) {
+        veri_file::AnalyzeLibFile(ext.c_str(), veri_file::SYSTEM_VERILOG_2005, unit.work.c_str());
+    }
+
+    Array file_names;
+    for (auto &file : unit.files)
+        file_names.Insert(Strings::save(file.c_str()));
+
+    bool ok = veri_file::AnalyzeMultipleFiles(&file_names, unit.mode, unit.work.c_str(), veri_file::MFCU);
+
+    int i;
+    char *f ;
+    FOREACH_ARRAY_ITEM(&file_names, i, f) Strings::free(f); 
+
+    if (!ok) {
+        std::cout << "ERROR: Reading Verilog/SystemVerilog sources failed.\n";
+        return false;
+    }
+    return true;
+}
+
+// ------------------------------
+// executePlan
+// ------------------------------
+static bool executePlan(analyzePlan& plan, const fs::path& vhdl_packages, profiler& prof) {
+    // Preloaded packages of another dialect would be picked up instead of
+    // the ones the design is analyzed with
+    for (auto &unit : plan.units) {
+        if (!unit.isVhdl)
+            continue;
+        if (!residentVhdlPackages.empty() && residentVhdlPackages != vhdlPackagesDir(unit.mode))
+            vhdl_file::RemoveAllUnits();
+        residentVhdlPackages.clear();
+        break;
+    }
+
+    std::unique_ptr<parseCache> cache;
+    if (!plan.cacheDir.empty()) {
+        profiler::phase phase(prof, "parse cache lookup");
+        cache = std::make_unique<parseCache>(plan.cacheDir, plan.cacheLimitMB);
+        cache->plan(plan.units);
+    }
+
+    for (auto &step : plan.steps) {
+        if (step.unit < 0) {
+            step.apply();
+            continue;
+        }
+
+        const compileUnit& unit = plan.units[step.unit];
+        prepareUnit(unit, vhdl_packages);
+        if (cache && unit.restore) {
+            profiler::phase phase(prof, "parse cache restore", unit.work);
+            if (cache->restore(unit))
+                continue;
+        }
+        if (cache)
+            cache->markLibrary(unit);
+        {
+            profiler::phase phase(prof, unit.isVhdl ? "vhdl analysis" : "verilog analysis", unit.work);
+            if (!analyzeUnit(unit))
+                return false;
+        }
+        if (cache) {
+            profiler::phase phase(prof, "parse cache save", unit.work);
+            cache->save(unit);
+        }
+    }
+
+    if (cache) {
+        std::cout << "INFO: Restored " << cache->restoredCount() << " of " << plan.units.size()
+            << " compilation units from parse cache " << plan.cacheDir << std::endl;
+        profiler::phase phase(prof, "parse cache prune");
+        cache->prune(plan.units);
+    }
+    return true;
+}
+
+// ------------------------------
+// dumpLibrary
+// ------------------------------
+// Elaborates the top modules of a work library (unless only ports are
+// dumped) and adds their records to the dumps. hierTree is null when the
+// hierarchy is not dumped.
+static void dumpLibrary(const std::string& w, const analyzePlan& plan, portDump* ports,
+        hierDump* hierTree, profiler& prof) {
+    VeriLibrary *veri_lib = veri_file::GetLibrary(w.c_str(), 1);
+    VhdlLibrary *vhdl_lib = vhdl_file::GetLibrary(w.c_str(), 1);
+
+    Array m;
+    Array u;
+    Array *modules;
+    Array *units;
+    if (!plan.top_module.empty()) {
+        VeriModule *veri_module = veri_lib ? veri_lib->GetModule(plan.top_module.c_str(), 1) : nullptr;
+        if (veri_module) {
+            m.InsertLast(veri_module);
+        }
+        VhdlDesignUnit *vhdl_unit = vhdl_lib ? vhdl_lib->GetPrimUnit(plan.top_module.c_str()) : nullptr;
+        if (vhdl_unit) {
+            u.InsertLast(vhdl_unit);
+        }
+        if (!plan.portsOnly) {
+            profiler::phase phase(prof, "elaboration", w);
+            hier_tree::Elaborate(&m, &u, 0);
+        }
+        modules = &m;
+        units = &u;
+    } else {
+        Array veri_libs, vhdl_libs;
+        if (vhdl_lib) vhdl_libs.InsertLast(vhdl_lib);
+        if (veri_lib) veri_libs.InsertLast(veri_lib);
+        if (!plan.portsOnly) {
+            profiler::phase phase(prof, "elaboration", w);
+            hier_tree::ElaborateAll(&veri_libs, &vhdl_libs, 0);
+        }
+        modules = veri_file::GetTopModules(w.c_str());
+        units = vhdl_file::GetTopDesignUnits(w.c_str());
+    }
+    // The hierarchy walk also produces the port records
+    if (hierTree) {
+        profiler::phase phase(prof, "port and hierarchy dump", w);
+        hierTree->saveInfo(modules, units, ports);
+    } else {
+        profiler::phase phase(prof, "port dump", w);
+        ports->saveInfo(modules, units);
+    }
+}
+
+#ifndef _WIN32
+// ------------------------------
+// dumpLibraryWorker
+// ------------------------------
+// Runs in a forked worker: dumps one library and writes its records to
+// the partial file. The dumps are local so that their spool files are
+// removed before the worker exits.
+static int dumpLibraryWorker(const std::string& w, const analyzePlan& plan, bool dumpHierTree,
+        const fs::path& part) {
+    try {
+        profiler prof;
+        portDump ports("port_info.json");
+        hierDump hierTree("hier_info.json");
+        ports.setFormat(outputFormat::compactJson);
+        hierTree.setFormat(outputFormat::compactJson);
+        ports.setElaborated(!plan.portsOnly);
+        hierTree.setHierScope(plan.hierRoot, plan.hierDepth);
+        hierTree.setSignalFilter(plan.signals);
+        // Only for the instance links of the records, see savePartial
+        hierTree.setIndexed(plan.hierIndex);
+        dumpLibrary(w, plan, &ports, dumpHierTree ? &hierTree : nullptr, prof);
+        std::ofstream out(part);
+        ports.savePartial(out);
+        if (dumpHierTree)
+            hierTree.savePartial(out);
+        out.close();
+        return out ? 0 : 1;
+    } catch (std::exception const& ex) {
+        std::cout << "ERROR: Dump of library " << w << " failed: " << ex.what() << std::endl;
+        return 1;
+    }
+}
+
+// ------------------------------
+// dumpLibrariesInWorkers
+// ------------------------------
+// Libraries are elaborated and dumped by up to plan.jobs forked workers,
+// which share the analyzed parse trees with this process. Their records
+// are merged in library order, so the outputs are those of a sequential
+// run.
+static bool dumpLibrariesInWorkers(const analyzePlan& plan, portDump* ports, hierDump* hierTree,
+        profiler& prof) {
+    std::vector<std::string> works(plan.works.begin(), plan.works.end());
+    std::vector<fs::path> parts;
+    for (size_t i = 0; i < works.size(); i++) {
+        parts.push_back(fs::temp_directory_path() /
+                ("analyze_part_" + std::to_string(getpid()) + "_" + std::to_string(i)));
+        // Left over by an earlier process with the same ID, it must not
+        // stand in for the records of a worker that failed
+        std::error_code ec;
+        fs::remove(parts.back(), ec);
+    }
+
+    bool ok = true;
+    {
+        profiler::phase phase(prof, "parallel elaboration and dump");
+        std::map<pid_t, size_t> running;
+        size_t next = 0;
+        while (next < works.size() || !running.empty()) {
+            if (next < works.size() && (int)running.size() < plan.jobs) {
+                std::cout.flush();
+                pid_t pid = fork();
+                if (pid == 0)
+                    _exit(dumpLibraryWorker(works[next], plan, hierTree != nullptr, parts[next]));
+                if (pid < 0) {
+                    std::cout << "ERROR: Could not fork worker for library " << works[next] << std::endl;
+                    ok = false;
+                    next = works.size();
+                    continue;
                 }
-                VhdlDesignUnit *vhdl_unit = vhdl_lib ? vhdl_lib->GetPrimUnit(top_module.c_str()) : nullptr;
-                if (vhdl_unit) {
-                    u.InsertLast(vhdl_unit);
+                running[pid] = next++;
+                continue;
+            }
+            int status = 0;
+            pid_t pid = wait(&status);
+            if (pid < 0) {
+                if (errno == EINTR)
+                    continue;
+                // The exit codes of the workers are lost (SIGCHLD ignored)
+                std::cout << "ERROR: Could not wait for library workers: " << strerror(errno) << std::endl;
+                ok = false;
+                // Workers left running would keep writing the part files
+                // removed below
+                for (auto& worker : running) {
+                    kill(worker.first, SIGKILL);
+                    while (waitpid(worker.first, &status, 0) < 0 && errno == EINTR) {}
                 }
-                hier_tree::Elaborate(&m, &u, 0);
-                modules = &m;
-                units = &u;
-            } else {
-                Array veri_libs, vhdl_libs;
-                if (vhdl_lib) vhdl_libs.InsertLast(vhdl_lib);
-                if (veri_lib) veri_libs.InsertLast(veri_lib);
-                hier_tree::ElaborateAll(&veri_libs, &vhdl_libs, 0);
-                modules = veri_file::GetTopModules(w.c_str());
-                units = vhdl_file::GetTopDesignUnits(w.c_str());
-            }
-                ports->saveInfo(modules, units);
-                if (dumpHierTree)
-                    hierTree->saveInfo(modules, units);
+                running.clear();
+                break;
+            }
+            auto worker = running.find(pid);
+            if (worker == running.end())
+                continue;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                std::cout << "ERROR: Worker for library " << works[worker->second] << " failed." << std::endl;
+                ok = false;
+            }
+            running.erase(worker);
+        }
+    }
+
+    if (ok) {
+        profiler::phase phase(prof, "merge");
+        for (size_t i = 0; i < parts.size(); i++) {
+            std::ifstream in(parts[i]);
+            if (!in) {
+                std::cout << "ERROR: Missing records of library " << works[i] << "." << std::endl;
+                ok = false;
+                break;
+            }
+            std::string text;
+            while (std::getline(in, text)) {
+                json line = json::parse(text);
+                if (line.contains("port"))
+                    ports->mergePartial(line);
+                else if (hierTree)
+                    hierTree->mergePartial(line);
+            }
+        }
+    }
+    for (auto& part : parts) {
+        std::error_code ec;
+        fs::remove(part, ec);
+    }
+    return ok;
+}
+#endif
+
+// ------------------------------
+// runInstructionFile
+// ------------------------------
+// defaultCacheDir is used as parse cache when the instruction file sets none
+static int runInstructionFile(const fs::path& file_path, const fs::path& vhdl_packages,
+        const fs::path& defaultCacheDir = fs::path()) {
+    std::ifstream in(file_path);
+    if (!in) {
+        std::cout << "ERROR: Could not open instruction file: " << file_path << std::endl;
+        return 1;
+    }
+
+    profiler prof;
+    auto start = std::chrono::steady_clock::now();
+    analyzePlan plan;
+    {
+        profiler::phase phase(prof, "file list expansion");
+        if (!parseInstructions(in, plan))
+            return 1;
+    }
+    if (plan.cacheDir.empty())
+        plan.cacheDir = defaultCacheDir;
+    if (!executePlan(plan, vhdl_packages, prof))
+        return 1;
+    auto analyzed = std::chrono::steady_clock::now();
+
+    // Pin planning only needs the ports of the top modules, which are
+    // available from the parse trees
+    bool dumpHierTree = !plan.portsOnly;
+
+
+    // Owned here so that the spool files of the records are removed on
+    // every return path
+    std::unique_ptr<portDump> ports = std::make_unique<portDump>("port_info.json");
+    std::unique_ptr<hierDump> hierTree = std::make_unique<hierDump>("hier_info.json");
+    ports->setFormat(plan.format);
+    hierTree->setFormat(plan.format);
+    ports->setElaborated(!plan.portsOnly);
+    hierTree->setHierScope(plan.hierRoot, plan.hierDepth);
+    hierTree->setDedup(plan.hierDedup);
+    hierTree->setIndexed(plan.hierIndex);
+    hierTree->setSignalFilter(plan.signals);
+    if (!plan.hierDelta.empty())
+        hierTree->setDelta(plan.hierDelta);
+
+    // Within one process -jobs threads serialize the records. The pool is
+    // not created before forking library workers, they run single threaded.
+    std::unique_ptr<threadPool> pool;
+#ifndef _WIN32
+    if (plan.jobs > 1 && plan.works.size() > 1) {
+        if (!dumpLibrariesInWorkers(plan, ports.get(), dumpHierTree ? hierTree.get() : nullptr, prof))
+            return 1;
+    } else
+#endif
+    {
+        if (plan.jobs > 1) {
+            pool = std::make_unique<threadPool>(plan.jobs);
+            ports->setThreadPool(pool.get());
+            hierTree->setThreadPool(pool.get());
         }
+        for (auto &w : plan.works)
+            dumpLibrary(w, plan, ports.get(), dumpHierTree ? hierTree.get() : nullptr, prof);
+    }
 
+    {
+        profiler::phase phase(prof, "json write");
         ports->saveJson();
         if (dumpHierTree)
             hierTree->saveJson();
+    }
+
+    if (plan.portsOnly) {
+        std::chrono::duration<double> analysis = analyzed - start;
+        std::chrono::duration<double> dump = std::chrono::steady_clock::now() - analyzed;
+        std::cout << "INFO: Ports only: elaboration and hierarchy dump skipped, analysis took "
+            << analysis.count() << " s, port dump took " << dump.count() << " s" << std::endl;
+    }
+
+    if (plan.profile)
+        prof.save("analyze_profile.json");
+
+    return 0;
+}
+
+// ------------------------------
+// watchedFiles
+// ------------------------------
+// Everything the analysis of the instruction file reads. Included headers
+// are found through the include directories and the directories of the
+// sources, which are watched as a whole, except for what the run writes.
+static analyzeWatch::watchSet watchedFiles(const fs::path& file_path, const fs::path& defaultCacheDir) {
+    analyzeWatch::watchSet set;
+    set.files.push_back(file_path);
+    std::ifstream in(file_path);
+    analyzePlan plan;
+    if (!in || !parseInstructions(in, plan))
+        return set;
+    std::set<std::string> dirs;
+    for (auto& unit : plan.units) {
+        set.files.insert(set.files.end(), unit.files.begin(), unit.files.end());
+        set.files.insert(set.files.end(), unit.libfiles.begin(), unit.libfiles.end());
+        dirs.insert(unit.incdirs.begin(), unit.incdirs.end());
+        dirs.insert(unit.libdirs.begin(), unit.libdirs.end());
+        if (!unit.isVhdl) {
+            for (auto& file : unit.files)
+                dirs.insert(fs::absolute(file).parent_path().string());
+        }
+    }
+    set.dirs.assign(dirs.begin(), dirs.end());
+
+    std::string ext = outputExtension(plan.format);
+    set.ignored = {"port_info" + ext, "hier_info" + ext, "hier_info_delta" + ext, "analyze_profile.json",
+        plan.cacheDir.empty() ? defaultCacheDir : plan.cacheDir};
+    if (!plan.hierDelta.empty())
+        set.ignored.push_back(plan.hierDelta);
+    return set;
+}
+
+// ------------------------------
+// main
+// ------------------------------
+int main (int argc, char* argv[]) {
+
+    try {
+        fs::path file_path;
+        std::string server_socket;
+        std::string connect_socket;
+        std::string preload = "2008";
+        std::vector<std::string> convert;
+        bool watch = false;
+        bool packagesShm = false;
+
+        if (argc < 3) {
+            print_help();
+            return 1;
+        }
+
+        int argidx = 1;
+
+        while (argidx < argc) {
+            if (std::string(argv[argidx]) == "-f" && argidx + 1 < argc) {
+                file_path = std::string(argv[++argidx]);
+                argidx++;
+                continue;
+            } else if (std::string(argv[argidx]) == "-server" && argidx + 1 < argc) {
+                server_socket = argv[++argidx];
+                argidx++;
+                continue;
+            } else if (std::string(argv[argidx]) == "-connect" && argidx + 1 < argc) {
+                connect_socket = argv[++argidx];
+                argidx++;
+                continue;
+            } else if (std::string(argv[argidx]) == "-convert" && argidx + 2 < argc) {
+                convert = {argv[argidx + 1], argv[argidx + 2]};
+                argidx += 3;
+                continue;
+            } else if (std::string(argv[argidx]) == "-vhdl-packages-shm") {
+                packagesShm = true;
+                argidx++;
+                continue;
+            } else if (std::string(argv[argidx]) == "-watch") {
+                watch = true;
+                argidx++;
+                continue;
+            } else if (std::string(argv[argidx]) == "-vhdl-preload" && argidx + 1 < argc) {
+                preload = argv[++argidx];
+                argidx++;
+                continue;
+            } else {
+                std::cout << "ERROR: Invalid option is specified. " << std::endl;
+                print_help();
+                return 1;
+            }
+        }
+
+        if (!convert.empty()) {
+            analyzeOutput::write(analyzeOutput::read(convert[0]), convert[1]);
+            return 0;
+        }
+
+#ifdef _WIN32
+        if (!server_socket.empty() || !connect_socket.empty()) {
+            std::cout << "ERROR: -server and -connect are not supported on Windows." << std::endl;
+            return 1;
+        }
+#else
+        // The client does no analysis itself, the server holds the license
+        if (!connect_socket.empty())
+            return analyzeServer::request(connect_socket, file_path);
+#endif
+
+#ifdef PRODUCTION_BUILD
+        License_Manager license(License_Manager::LicensedProductName::ANALYZE);
+#endif
 
-        return 0;
+        ieee_1735 protect;
+        veri_file::SetPragmaProtectObject(&protect);
+
+        fs::path vhdl_packages;
+        if (!get_packages_path("analyze", vhdl_packages)) {
+            return 1;
+        }
+#ifndef _WIN32
+        if (packagesShm)
+            vhdl_packages = stageVhdlPackages(vhdl_packages);
+#endif
+
+#ifndef _WIN32
+        if (!server_socket.empty() || watch) {
+            if (preload != "1987" && preload != "1993" && preload != "2008") {
+                std::cout << "ERROR: -vhdl-preload expects 1987, 1993 or 2008." << std::endl;
+                return 1;
+            }
+            preloadVhdlPackages(vhdl_packages, "vdbs_" + preload);
+        }
+        if (!server_socket.empty()) {
+            return analyzeServer::run(server_socket, [&vhdl_packages](const fs::path& file) {
+                    return runInstructionFile(file, vhdl_packages);
+                    });
+        }
+#endif
+
+        // Runs are forked from the watching process, the parse cache is what
+        // carries the unchanged units from one run to the next
+        if (watch) {
+            if (file_path.empty()) {
+                std::cout << "ERROR: -watch needs an instruction file given with -f." << std::endl;
+                return 1;
+            }
+            fs::path cacheDir = fs::absolute(".analyze_watch_cache");
+            return analyzeWatch::run([&file_path, &cacheDir]() { return watchedFiles(file_path, cacheDir); },
+                    [&]() { return runInstructionFile(file_path, vhdl_packages, cacheDir); });
+        }
+
+        return runInstructionFile(file_path, vhdl_packages);
     }
     catch (fs::filesystem_error const& ex) {
         std::cout << "ANALYZE: ERROR : " << ex.what() << std::endl;
@@ -450,6 +1230,10 @@ int main (int argc, char* argv[]) {
         return 1;
     }
 #endif
+    catch (std::exception const& ex) {
+        std::cout << "ANALYZE: ERROR : " << ex.what() << std::endl;
+        return 1;
+    }
     catch (...) {
         std::cout << "ANALYZE: ERROR : Unhandled exception." << std::endl;
         return 1;
@@ -0,0 +1,208 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#ifndef _WIN32
+
+#include <iostream>
+#include <sstream>
+#include <cerrno>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "analyze_server.h"
+
+namespace fs = std::filesystem;
+
+static const char* exitMarker = "ANALYZE-EXIT ";
+
+// ------------------------------
+// bindAddress
+// ------------------------------
+static bool bindAddress(const std::string& socketPath, sockaddr_un& addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        std::cout << "ERROR: Socket path is too long: " << socketPath << std::endl;
+        return false;
+    }
+    strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    return true;
+}
+
+// ------------------------------
+// readLine
+// ------------------------------
+static bool readLine(int fd, std::string& line) {
+    line.clear();
+    char c;
+    while (read(fd, &c, 1) == 1) {
+        if (c == '\n')
+            return true;
+        line += c;
+    }
+    return false;
+}
+
+// ------------------------------
+// writeAll
+// ------------------------------
+static bool writeAll(int fd, const std::string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t res = write(fd, data.data() + done, data.size() - done);
+        if (res <= 0)
+            return false;
+        done += res;
+    }
+    return true;
+}
+
+// ------------------------------
+// serveRequest
+// ------------------------------
+// Runs in the forked child, stdout and stderr go to the client
+static int serveRequest(int client,
+        const std::function<int(const fs::path&)>& runInstructionFile) {
+    std::string cwd;
+    std::string file;
+    if (!readLine(client, cwd) || !readLine(client, file)) {
+        writeAll(client, "ERROR: Malformed analyze request.\n" + std::string(exitMarker) + "1\n");
+        return 1;
+    }
+
+    std::cout.flush();
+    dup2(client, STDOUT_FILENO);
+    dup2(client, STDERR_FILENO);
+
+    int res = 1;
+    if (chdir(cwd.c_str()) != 0)
+        std::cout << "ERROR: Could not change directory to " << cwd << std::endl;
+    else
+        res = runInstructionFile(file);
+
+    std::cout << exitMarker << res << std::endl;
+    return res;
+}
+
+// ------------------------------
+// run
+// ------------------------------
+int analyzeServer::run(const std::string& socketPath,
+        const std::function<int(const fs::path&)>& runInstructionFile) {
+    sockaddr_un addr;
+    if (!bindAddress(socketPath, addr))
+        return 1;
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        std::cout << "ERROR: Could not create socket: " << strerror(errno) << std::endl;
+        return 1;
+    }
+    // A socket left by an earlier server is replaced, anything else at the
+    // path, or a socket of another user, is not
+    struct stat st;
+    if (lstat(socketPath.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode) || st.st_uid != getuid()) {
+            std::cout << "ERROR: " << socketPath << " exists and is not a socket of this user." << std::endl;
+            close(server);
+            return 1;
+        }
+        unlink(socketPath.c_str());
+    }
+    // Requests run instruction files as this user, only this user may
+    // connect
+    mode_t mask = umask(077);
+    int bound = bind(server, (sockaddr*)&addr, sizeof(addr));
+    umask(mask);
+    if (bound != 0 || chmod(socketPath.c_str(), 0600) != 0 || listen(server, 16) != 0) {
+        std::cout << "ERROR: Could not listen on " << socketPath << ": " << strerror(errno) << std::endl;
+        close(server);
+        return 1;
+    }
+
+    // Children are never waited for
+    signal(SIGCHLD, SIG_IGN);
+    std::cout << "INFO: analyze server listening on " << socketPath << std::endl;
+
+    while (true) {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR)
+                continue;
+            std::cout << "ERROR: accept failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(server);
+            // The request waits for its own workers (-jobs)
+            signal(SIGCHLD, SIG_DFL);
+            int res = serveRequest(client, runInstructionFile);
+            std::cout.flush();
+            _exit(res);
+        }
+        if (pid < 0)
+            writeAll(client, "ERROR: Could not fork analyze request.\n" + std::string(exitMarker) + "1\n");
+        close(client);
+    }
+
+    close(server);
+    unlink(socketPath.c_str());
+    return 1;
+}
+
+// ------------------------------
+// request
+// ------------------------------
+int analyzeServer::request(const std::string& socketPath, const fs::path& instructionFile) {
+    sockaddr_un addr;
+    if (!bindAddress(socketPath, addr))
+        return 1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        std::cout << "ERROR: Could not connect to analyze server " << socketPath << ": " << strerror(errno) << std::endl;
+        if (fd >= 0)
+            close(fd);
+        return 1;
+    }
+
+    std::string req = fs::current_path().string() + "\n" + fs::absolute(instructionFile).string() + "\n";
+    if (!writeAll(fd, req)) {
+        std::cout << "ERROR: Could not send request to analyze server." << std::endl;
+        close(fd);
+        return 1;
+    }
+
+    // Forward the output line by line, the last one carries the exit code
+    int res = 1;
+    std::string pending;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        pending.append(buf, n);
+        size_t eol;
+        while ((eol = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, eol);
+            pending.erase(0, eol + 1);
+            if (line.compare(0, strlen(exitMarker), exitMarker) == 0)
+                res = atoi(line.c_str() + strlen(exitMarker));
+            else
+                std::cout << line << "\n";
+        }
+    }
+    std::cout << pending << std::flush;
+    close(fd);
+    return res;
+}
+
+#endif
@@ -0,0 +1,29 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#ifndef ANALYZE_SERVER_H
+#define ANALYZE_SERVER_H
+
+#include <string>
+#include <functional>
+#include <filesystem>
+
+// Resident analyze: a request is the working directory and the instruction
+// file of one "analyze -f" call. Every request runs in a child forked from
+// the server, so the Verific state loaded once by the server (license,
+// VHDL packages) is shared while requests never see each other's designs.
+// The child's output is sent back to the client, followed by the status line.
+namespace analyzeServer {
+
+    // Serves requests on the given Unix socket until the process is killed
+    int run(const std::string& socketPath,
+            const std::function<int(const std::filesystem::path&)>& runInstructionFile);
+
+    // Sends the instruction file to a server and returns its exit code
+    int request(const std::string& socketPath, const std::filesystem::path& instructionFile);
+}
+
+#endif
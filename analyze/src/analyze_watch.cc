@@ -0,0 +1,200 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#include <iostream>
+
+#include "analyze_watch.h"
+
+namespace fs = std::filesystem;
+
+#ifdef __linux__
+
+#include <map>
+#include <algorithm>
+#include <set>
+#include <cerrno>
+#include <string.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/inotify.h>
+
+// Changes arriving within this delay of each other trigger one run, editors
+// and checkouts touch several files in a row
+static const int settleMs = 200;
+
+// Editors often save by writing a new file and renaming it over the old
+// one, so the directories are watched rather than the files
+static const uint32_t watchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM;
+
+// ------------------------------
+// normalize
+// ------------------------------
+static fs::path normalize(const fs::path& path) {
+    std::error_code ec;
+    fs::path res = fs::weakly_canonical(fs::absolute(path, ec), ec);
+    return ec ? path.lexically_normal() : res;
+}
+
+// ------------------------------
+// runChild
+// ------------------------------
+static int runChild(const std::function<int()>& runOnce) {
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::cout << "ERROR: Could not fork analyze run: " << strerror(errno) << std::endl;
+        return 1;
+    }
+    if (pid == 0) {
+        int status = runOnce();
+        std::cout.flush();
+        _exit(status);
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+class watcher {
+    public:
+        watcher(): fd(inotify_init1(IN_CLOEXEC)) {}
+
+        ~watcher() {
+            if (fd >= 0)
+                close(fd);
+        }
+
+        bool valid() const { return fd >= 0; }
+
+        size_t size() const { return files.size() + anyFileDirs.size(); }
+
+        void add(const analyzeWatch::watchSet& set) {
+            for (auto& file : set.files) {
+                fs::path path = normalize(file);
+                files.insert(path);
+                addDir(path.parent_path());
+            }
+            for (auto& dir : set.dirs) {
+                fs::path path = normalize(dir);
+                anyFileDirs.insert(path);
+                addDir(path);
+            }
+            for (auto& path : set.ignored)
+                ignored.insert(normalize(path));
+        }
+
+        // Blocks until a watched file has changed, then until the changes settle
+        bool waitForChange() {
+            bool changed = false;
+            while (!changed) {
+                if (!readEvents(-1, changed))
+                    return false;
+            }
+            bool more = true;
+            while (more) {
+                more = false;
+                if (!readEvents(settleMs, more))
+                    return false;
+            }
+            return true;
+        }
+
+    private:
+        void addDir(const fs::path& dir) {
+            for (auto& watched : dirs) {
+                if (watched.second == dir)
+                    return;
+            }
+            int wd = inotify_add_watch(fd, dir.c_str(), watchMask);
+            if (wd < 0) {
+                std::cout << "WARNING: Could not watch " << dir << ": " << strerror(errno) << std::endl;
+                return;
+            }
+            dirs[wd] = dir;
+        }
+
+        // The run writes its outputs and its parse cache next to the sources,
+        // often into an include directory, and editors write hidden swap
+        // files there. None of them is a reason to run again.
+        bool isIgnored(const fs::path& path, const char* name) const {
+            if (name[0] == '.')
+                return true;
+            // The path itself or anything below an ignored directory
+            for (auto& item : ignored) {
+                if (std::mismatch(item.begin(), item.end(), path.begin(), path.end()).first == item.end())
+                    return true;
+            }
+            return false;
+        }
+
+        // Returns false on error, timeout is in ms (-1 to wait forever)
+        bool readEvents(int timeout, bool& changed) {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            int res = poll(&pfd, 1, timeout);
+            if (res < 0)
+                return errno == EINTR;
+            if (res == 0)
+                return true;
+            alignas(struct inotify_event) char buffer[4096];
+            ssize_t len = read(fd, buffer, sizeof(buffer));
+            if (len < 0)
+                return errno == EINTR || errno == EAGAIN;
+            for (char* p = buffer; p < buffer + len; ) {
+                struct inotify_event* event = (struct inotify_event*)p;
+                p += sizeof(struct inotify_event) + event->len;
+                auto dir = dirs.find(event->wd);
+                if (dir == dirs.end())
+                    continue;
+                if (event->mask & IN_Q_OVERFLOW) {
+                    changed = true;
+                    continue;
+                }
+                if (!event->len)
+                    continue;
+                fs::path path = dir->second / event->name;
+                if (files.count(path) || (anyFileDirs.count(dir->second) && !isIgnored(path, event->name)))
+                    changed = true;
+            }
+            return true;
+        }
+
+        int fd;
+        std::map<int, fs::path> dirs;
+        std::set<fs::path> files;
+        std::set<fs::path> anyFileDirs;
+        std::set<fs::path> ignored;
+};
+
+int analyzeWatch::run(const std::function<watchSet()>& watchList, const std::function<int()>& runOnce) {
+    while (true) {
+        // Watching starts before the run, so that edits made while it is
+        // going on are not missed
+        watcher watch;
+        if (!watch.valid()) {
+            std::cout << "ERROR: Could not initialize file watching: " << strerror(errno) << std::endl;
+            return 1;
+        }
+        watch.add(watchList());
+        int status = runChild(runOnce);
+        std::cout << "INFO: Run finished with status " << status << ", watching " << watch.size()
+            << " files and directories for changes." << std::endl;
+        if (!watch.waitForChange()) {
+            std::cout << "ERROR: Watching files failed: " << strerror(errno) << std::endl;
+            return 1;
+        }
+        std::cout << "INFO: Sources changed, running again." << std::endl;
+    }
+}
+
+#else
+
+int analyzeWatch::run(const std::function<watchSet()>&, const std::function<int()>&) {
+    std::cout << "ERROR: -watch is only supported on Linux." << std::endl;
+    return 1;
+}
+
+#endif
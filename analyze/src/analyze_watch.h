@@ -0,0 +1,31 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#ifndef ANALYZE_WATCH_H
+#define ANALYZE_WATCH_H
+
+#include <vector>
+#include <functional>
+#include <filesystem>
+
+// Watch mode: the instruction file is run again each time one of the files
+// it reads changes. Every run is forked from the watching process, which
+// keeps no design, and goes through the parse cache, so only the
+// compilation units whose sources changed are analyzed again.
+namespace analyzeWatch {
+
+    struct watchSet {
+        std::vector<std::filesystem::path> files;   // instruction file, sources, library files
+        std::vector<std::filesystem::path> dirs;    // include, library and source directories, any file counts
+        std::vector<std::filesystem::path> ignored; // outputs and caches of the run, files or whole directories
+    };
+
+    // Runs until the process is killed. watchList is called before every
+    // run, the instruction file itself may add or remove sources.
+    int run(const std::function<watchSet()>& watchList, const std::function<int()>& runOnce);
+}
+
+#endif
@@ -0,0 +1,52 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "content_hash.h"
+
+contentHash::contentHash() {
+    ctx = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr);
+}
+
+contentHash::~contentHash() {
+    EVP_MD_CTX_free(ctx);
+}
+
+void contentHash::add(const std::string& data) {
+    add(data.data(), data.size());
+}
+
+void contentHash::add(const char* data, size_t size) {
+    uint64_t len = size;
+    EVP_DigestUpdate(ctx, &len, sizeof(len));
+    EVP_DigestUpdate(ctx, data, size);
+}
+
+bool contentHash::addFile(const std::filesystem::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        add("<missing>");
+        return false;
+    }
+    std::ostringstream content;
+    content << in.rdbuf();
+    add(content.str());
+    return true;
+}
+
+std::string contentHash::hex() {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int size = 0;
+    EVP_DigestFinal_ex(ctx, digest, &size);
+    std::ostringstream res;
+    for (unsigned int i = 0; i < size; i++)
+        res << std::hex << std::setw(2) << std::setfill('0') << (int)digest[i];
+    return res.str();
+}
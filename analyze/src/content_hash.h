@@ -0,0 +1,40 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <string>
+#include <filesystem>
+
+#include <openssl/evp.h>
+
+// SHA-256 digest accumulated over strings and file contents.
+class contentHash {
+    public:
+        contentHash();
+
+        ~contentHash();
+
+        contentHash(const contentHash&) = delete;
+
+        contentHash& operator=(const contentHash&) = delete;
+
+        // Length-prefixed, so that consecutive fields cannot run into each other
+        void add(const std::string& data);
+
+        void add(const char* data, size_t size);
+
+        // Returns false (and hashes a marker instead) when the file cannot be read
+        bool addFile(const std::filesystem::path& file);
+
+        std::string hex();
+
+    private:
+        EVP_MD_CTX* ctx;
+};
+
+#endif
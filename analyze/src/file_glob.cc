@@ -0,0 +1,235 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#include <algorithm>
+#include <filesystem>
+
+#include "file_glob.h"
+
+namespace fs = std::filesystem;
+
+// ------------------------------
+// split
+// ------------------------------
+static std::vector<std::string> split(const std::string& path) {
+    std::vector<std::string> res;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos)
+            end = path.size();
+        if (end > start)
+            res.push_back(path.substr(start, end - start));
+        start = end + 1;
+    }
+    return res;
+}
+
+static bool hasWildcard(const std::string& component) {
+    return component.find_first_of("*?[") != std::string::npos;
+}
+
+bool fileGlob::isPattern(const std::string& arg) {
+    return arg.find_first_of("*?[{") != std::string::npos;
+}
+
+// ------------------------------
+// expandBraces
+// ------------------------------
+// The first outermost {...} is expanded, then the results again
+std::vector<std::string> fileGlob::expandBraces(const std::string& pattern) {
+    size_t open = pattern.find('{');
+    if (open == std::string::npos)
+        return {pattern};
+    int depth = 0;
+    std::vector<std::string> alternatives;
+    size_t start = open + 1;
+    for (size_t i = open; i < pattern.size(); i++) {
+        char c = pattern[i];
+        if (c == '{') {
+            depth++;
+        } else if (c == ',' && depth == 1) {
+            alternatives.push_back(pattern.substr(start, i - start));
+            start = i + 1;
+        } else if (c == '}' && --depth == 0) {
+            alternatives.push_back(pattern.substr(start, i - start));
+            std::vector<std::string> res;
+            for (auto& alternative : alternatives) {
+                std::string expanded = pattern.substr(0, open) + alternative + pattern.substr(i + 1);
+                for (auto& r : expandBraces(expanded))
+                    res.push_back(r);
+            }
+            return res;
+        }
+    }
+    // Unbalanced, taken literally
+    return {pattern};
+}
+
+// ------------------------------
+// matchComponent
+// ------------------------------
+bool fileGlob::matchComponent(const char* pattern, const char* name) {
+    // Like a shell, wildcards do not match a leading dot
+    if (*name == '.' && *pattern != '.')
+        return false;
+    const char* starPattern = nullptr;
+    const char* starName = nullptr;
+    while (*name) {
+        if (*pattern == '*') {
+            starPattern = ++pattern;
+            starName = name;
+            continue;
+        }
+        bool matched = false;
+        const char* next = pattern + 1;
+        if (*pattern == '?') {
+            matched = true;
+        } else if (*pattern == '[') {
+            const char* p = pattern + 1;
+            bool negate = (*p == '!' || *p == '^');
+            if (negate)
+                p++;
+            bool in = false;
+            bool first = true;
+            while (*p && (*p != ']' || first)) {
+                if (p[1] == '-' && p[2] && p[2] != ']') {
+                    in |= (*name >= p[0] && *name <= p[2]);
+                    p += 3;
+                } else {
+                    in |= (*name == *p);
+                    p++;
+                }
+                first = false;
+            }
+            if (*p == ']') {
+                matched = (in != negate);
+                next = p + 1;
+            } else {
+                matched = (*pattern == *name);
+            }
+        } else {
+            matched = (*pattern && *pattern == *name);
+        }
+        if (matched) {
+            pattern = next;
+            name++;
+        } else if (starPattern) {
+            pattern = starPattern;
+            name = ++starName;
+        } else {
+            return false;
+        }
+    }
+    while (*pattern == '*')
+        pattern++;
+    return !*pattern;
+}
+
+bool fileGlob::matchComponents(const std::vector<std::string>& pattern, size_t p,
+        const std::vector<std::string>& path, size_t n) {
+    if (p == pattern.size())
+        return n == path.size();
+    if (pattern[p] == "**") {
+        for (size_t skip = n; skip <= path.size(); skip++) {
+            if (matchComponents(pattern, p + 1, path, skip))
+                return true;
+        }
+        return false;
+    }
+    return n < path.size() && matchComponent(pattern[p].c_str(), path[n].c_str()) &&
+        matchComponents(pattern, p + 1, path, n + 1);
+}
+
+bool fileGlob::match(const std::string& pattern, const std::string& path) {
+    std::vector<std::string> components = split(path);
+    for (auto& alternative : expandBraces(pattern)) {
+        if (matchComponents(split(alternative), 0, components, 0))
+            return true;
+    }
+    return false;
+}
+
+const std::vector<fileGlob::entry>& fileGlob::list(const std::string& dir) {
+    auto it = listings.find(dir);
+    if (it != listings.end())
+        return it->second;
+    std::vector<entry>& entries = listings[dir];
+    std::error_code ec;
+    for (auto it = fs::directory_iterator(dir.empty() ? "." : dir, ec); !ec && it != fs::directory_iterator();
+            it.increment(ec)) {
+        std::error_code ignore;
+        entries.push_back({it->path().filename().string(), it->is_directory(ignore),
+                it->is_regular_file(ignore), it->is_symlink(ignore)});
+    }
+    std::sort(entries.begin(), entries.end(),
+            [](const entry& a, const entry& b) { return a.name < b.name; });
+    return entries;
+}
+
+// ------------------------------
+// walk
+// ------------------------------
+// dir is empty for the current directory, otherwise ends with '/'
+void fileGlob::walk(const std::string& dir, const std::vector<std::string>& components, size_t index,
+        std::vector<std::string>& files) {
+    const std::string& component = components[index];
+    bool last = index + 1 == components.size();
+    if (component == "**") {
+        // Directory symlinks are not followed here, a link back up the
+        // tree would make the recursion loop. "dir/**" is every file below dir.
+        if (!last)
+            walk(dir, components, index + 1, files);
+        for (auto& e : list(dir)) {
+            if (e.name[0] == '.')
+                continue;
+            if (e.isDir && !e.isLink)
+                walk(dir + e.name + "/", components, index, files);
+            else if (last && e.isFile)
+                files.push_back(dir + e.name);
+        }
+        return;
+    }
+    if (!hasWildcard(component)) {
+        std::string path = dir + component;
+        std::error_code ec;
+        if (last) {
+            if (fs::is_regular_file(path, ec))
+                files.push_back(path);
+        } else if (fs::is_directory(path, ec)) {
+            walk(path + "/", components, index + 1, files);
+        }
+        return;
+    }
+    for (auto& e : list(dir)) {
+        if (!matchComponent(component.c_str(), e.name.c_str()))
+            continue;
+        if (last && e.isFile)
+            files.push_back(dir + e.name);
+        else if (!last && e.isDir)
+            walk(dir + e.name + "/", components, index + 1, files);
+    }
+}
+
+std::vector<std::string> fileGlob::expand(const std::string& pattern, const std::vector<std::string>& excludes) {
+    std::vector<std::string> files;
+    for (auto& alternative : expandBraces(pattern)) {
+        std::vector<std::string> components = split(alternative);
+        if (components.empty())
+            continue;
+        walk(alternative[0] == '/' ? "/" : "", components, 0, files);
+    }
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    files.erase(std::remove_if(files.begin(), files.end(), [&excludes](const std::string& file) {
+                for (auto& exclude : excludes) {
+                    if (match(exclude, file))
+                        return true;
+                }
+                return false;
+                }), files.end());
+    return files;
+}
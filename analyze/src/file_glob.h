@@ -0,0 +1,54 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#ifndef FILE_GLOB_H
+#define FILE_GLOB_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+// Expansion of file patterns of the instruction file:
+//   *  ?  [abc]  [a-z]  [!abc]   within one path component
+//   **                           any number of directories
+//   {a,b}                        alternatives, may be nested
+// Results are sorted. Directory listings are cached for the lifetime of
+// the object, so an instruction file scanning the same tree several times
+// lists each directory once.
+class fileGlob {
+    public:
+        static bool isPattern(const std::string& arg);
+
+        // Files matching pattern, minus those matching one of excludes
+        std::vector<std::string> expand(const std::string& pattern, const std::vector<std::string>& excludes);
+
+        // Whole path match, "**" spans directories
+        static bool match(const std::string& pattern, const std::string& path);
+
+    private:
+        struct entry {
+            std::string name;
+            bool isDir;
+            bool isFile;
+            bool isLink;
+        };
+
+        static std::vector<std::string> expandBraces(const std::string& pattern);
+
+        static bool matchComponent(const char* pattern, const char* name);
+
+        static bool matchComponents(const std::vector<std::string>& pattern, size_t p,
+                const std::vector<std::string>& path, size_t n);
+
+        const std::vector<entry>& list(const std::string& dir);
+
+        void walk(const std::string& dir, const std::vector<std::string>& components, size_t index,
+                std::vector<std::string>& files);
+
+        std::map<std::string, std::vector<entry>> listings;
+};
+
+#endif
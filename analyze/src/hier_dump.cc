@@ -5,6 +5,7 @@
 // ---------------------------------------------------------------
 
 #include "hier_dump.h"
+#include "content_hash.h"
 
 
 
@@ -45,7 +46,7 @@ std::string hierDump::getVhdlMode(int mode)
     return "Undefined" ;
 }
 
-void hierDump::saveVeriInfo(Array *verilogModules, json& tree) {
+void hierDump::saveVeriInfo(Array *verilogModules, jsonSpool& tree) {
     int p;
     VeriModule* veriMod;
     FOREACH_ARRAY_ITEM(verilogModules, p, veriMod) {
@@ -55,6 +56,11 @@ void hierDump::saveVeriInfo(Array *verilogModules, json& tree) {
             continue;
         json module;
         module["topModule"] = veriMod->Name();
+        std::unordered_set<std::string> portNames;
+        saveVeriModulePortsInfo(veriMod, module, portNames);
+        saveTopPorts(module);
+        if (!enterTop(veriMod->Name()))
+            continue;
         LineFile* lineFile;
         std::string vFile = lineFile->GetFileName(veriMod->Linefile());
         module["file"] = getFileId(vFile);
@@ -62,22 +68,25 @@ void hierDump::saveVeriInfo(Array *verilogModules, json& tree) {
         module["line"] = vLine;
         module["language"] = getVeriMode(veriMod->GetAnalysisDialect());
         saveVeriModuleParamsInfo(veriMod, module);
-        std::unordered_set<std::string> portNames;
-        saveVeriModulePortsInfo(veriMod, module, portNames);
         saveVeriModuleInternalSignals(veriMod, module, portNames);
         saveVeriModuleInsts(veriMod, module);
-        tree.push_back(module);
+        saveTop(module);
     }
 }
 
-void hierDump::saveVhdlInfo(Array *vhdlModules, json& tree) {
+void hierDump::saveVhdlInfo(Array *vhdlModules, jsonSpool& tree) {
     int k;
     VhdlPrimaryUnit* mod;
     FOREACH_ARRAY_ITEM(vhdlModules, k, mod) {
         if (!mod)
-            return;
+            continue;
         json module;
         module["topModule"] = mod->Name();
+        std::unordered_set<std::string> portNames;
+        saveVhdlModulePortsInfo(mod, module, portNames);
+        saveTopPorts(module);
+        if (!enterTop(mod->Name()))
+            continue;
         LineFile* lineFile;
         std::string vFile = lineFile->GetFileName(mod->Linefile());
         module["file"] = getFileId(vFile);
@@ -85,17 +94,16 @@ void hierDump::saveVhdlInfo(Array *vhdlModules, json& tree) {
         module["line"] = vLine;
         module["language"] = getVhdlMode(mod->GetAnalysisDialect());
         saveVhdlModuleParamsInfo(mod, module);
-        std::unordered_set<std::string> portNames;
-        saveVhdlModulePortsInfo(mod, module, portNames);
         saveVhdlModuleInternalSignals(mod, module, portNames);
         saveVhdlModuleInsts(mod, module);
-        tree.push_back(module);
+        saveTop(module);
     }
 }
-void hierDump::SetVeriModuleId(VeriModule* veriMod, std::string paramList) {
+void hierDump::SetVeriModuleId(VeriModule* veriMod, unsigned variant) {
     if (!veriMod)
         return;
-    if (moduleIDs.find(paramList) == moduleIDs.end()) {
+    if (!isDumped(variant)) {
+        markExpanded(variant);
         json module;
         module["module"] = veriMod->Name();
         LineFile* lineFile;
@@ -109,8 +117,12 @@ void hierDump::SetVeriModuleId(VeriModule* veriMod, std::string paramList) {
         saveVeriModulePortsInfo(veriMod, module, portNames);
         saveVeriModuleInternalSignals(veriMod, module, portNames);
         saveVeriModuleInsts(veriMod, module);
-        modules[paramList] = module;
-        moduleIDs.insert(paramList);
+        saveModule(variants.text(variant), module);
+        setDumped(variant);
+    } else if (needsExpansion(variant)) {
+        // Dumped before with less levels left, only the instances are missing
+        json module;
+        saveVeriModuleInsts(veriMod, module);
     }
 }
 
@@ -166,11 +178,17 @@ void hierDump::saveVeriModuleInsts(VeriModule* veriMod, json& module) {
                                                          std::string vFile = lineFile->GetFileName(instance->Linefile());
                                                          unsigned vLine = lineFile->GetLineNo(instance->StartingLinefile());
                                                          json params = json::array();
-                                                         std::string paramList = saveVeriModuleInstParamInfo(moduleInstance, params);
-                                                         paramList = moduleInstance->GetModuleName() + paramList;
-                                                         SetVhdlModuleId(primUnit, paramList);
+                                                         variantTable::tuple key = {variants.intern(moduleInstance->GetModuleName())};
+                                                         saveVeriModuleInstParamInfo(moduleInstance, params, key);
+                                                         bool added;
+                                                         unsigned variant = variants.variant(key, added);
+                                                         hierScope saved;
+                                                         if (enterInstance(instance->Name() ? instance->Name() : "", variant, saved)) {
+                                                             SetVhdlModuleId(primUnit, variant);
+                                                             leaveInstance(saved);
+                                                         }
 							 if (instance->Name()) {
-                                                           module["moduleInsts"].push_back({{"instName", instance->Name()}, {"file", getFileId(vFile)}, {"line", vLine}, {"parameters", params}, {"module", paramList}});
+                                                           module["moduleInsts"].push_back({{"instName", instance->Name()}, {"file", getFileId(vFile)}, {"line", vLine}, {"parameters", params}, {"module", variants.text(variant)}});
 							 }
                                                      }
                                                  }
@@ -184,12 +202,18 @@ void hierDump::saveVeriModuleInsts(VeriModule* veriMod, json& module) {
                                                          std::string vFile = lineFile->GetFileName(instance->Linefile());
                                                          unsigned vLine = lineFile->GetLineNo(instance->StartingLinefile());
                                                          json params = json::array();
-                                                         std::string paramList = saveVeriModuleInstParamInfo(moduleInstance, params);
-                                                         paramList = moduleInstance->GetModuleName() + paramList;
-                                                         SetVeriModuleId(moduleInstance->GetInstantiatedModule(), paramList);
+                                                         variantTable::tuple key = {variants.intern(moduleInstance->GetModuleName())};
+                                                         saveVeriModuleInstParamInfo(moduleInstance, params, key);
+                                                         bool added;
+                                                         unsigned variant = variants.variant(key, added);
+                                                         hierScope saved;
+                                                         if (enterInstance(instance->Name() ? instance->Name() : "", variant, saved)) {
+                                                             SetVeriModuleId(moduleInstance->GetInstantiatedModule(), variant);
+                                                             leaveInstance(saved);
+                                                         }
 							 // Fix EDA-1361 : make sure instance name exists
 							 if (instance->Name()) {
-                                                           module["moduleInsts"].push_back({{"instName", instance->Name()}, {"file", getFileId(vFile)}, {"line", vLine}, {"parameters", params}, {"module", paramList}});
+                                                           module["moduleInsts"].push_back({{"instName", instance->Name()}, {"file", getFileId(vFile)}, {"line", vLine}, {"parameters", params}, {"module", variants.text(variant)}});
 							 }
                                                      }
                                                  }
@@ -217,9 +241,24 @@ std::string hierDump::getParamValue(VeriExpression *connection) {
                                VeriIdDef *id = idRef->FullId();
                                if (!id)
                                    return "Unknown";
+                               // Every instance connecting the same parameter
+                               // shares its value
+                               auto it = paramValues.find(id);
+                               if (it != paramValues.end())
+                                   return it->second;
                                VeriExpression *initVal = id->GetInitialValue() ; 
-                               return getParamValue(initVal);
+                               std::string val = getParamValue(initVal);
+                               paramValues.emplace(id, val);
+                               return val;
                            }
+        case ID_VERIBINARYOPERATOR:
+        case ID_VERIUNARYOPERATOR:
+        case ID_VERIQUESTIONCOLON: {
+                                       int val;
+                                       if (foldParamValue(connection, val))
+                                           return std::to_string(val);
+                                       return "Unknown";
+                                   }
         default: {
                      return "Unknown";
                  }
@@ -227,6 +266,95 @@ std::string hierDump::getParamValue(VeriExpression *connection) {
     return "Unknown";
 }
 
+bool hierDump::foldParamValue(VeriExpression *expr, int& value) {
+    if (!expr)
+        return false;
+    // Every leaf is a 32-bit signed integer, so is every operation. Anything
+    // whose result would not fit, or would depend on Verilog wrapping,
+    // is not folded.
+    switch (expr->GetClassId()) {
+        case ID_VERIINTVAL: {
+                                value = static_cast<VeriConst*>(expr)->Integer();
+                                return true;
+                            }
+        case ID_VERIIDREF: {
+                               VeriIdDef *id = static_cast<VeriIdRef*>(expr)->FullId();
+                               if (!id || !id->IsParam())
+                                   return false;
+                               auto it = paramInts.find(id);
+                               if (it == paramInts.end()) {
+                                   // Integer and untyped parameters only, a
+                                   // range or another type changes the value
+                                   VeriDataType *dataType = id->GetDataType();
+                                   unsigned type = id->Type();
+                                   int val = 0;
+                                   bool exact = (!dataType || !dataType->GetDimensions()) &&
+                                       (!type || type == VERI_INTEGER || type == VERI_INT) &&
+                                       foldParamValue(id->GetInitialValue(), val);
+                                   it = paramInts.emplace(id, std::make_pair(exact, val)).first;
+                               }
+                               value = it->second.second;
+                               return it->second.first;
+                           }
+        case ID_VERIBINARYOPERATOR: {
+                                        VeriBinaryOperator *pOperator = static_cast<VeriBinaryOperator*>(expr);
+                                        int l, r;
+                                        if (!foldParamValue(pOperator->GetLeft(), l) || !foldParamValue(pOperator->GetRight(), r))
+                                            return false;
+                                        switch (pOperator->OperType()) {
+                                            case VERI_PLUS: return !__builtin_add_overflow(l, r, &value);
+                                            case VERI_MIN: return !__builtin_sub_overflow(l, r, &value);
+                                            case VERI_MUL: return !__builtin_mul_overflow(l, r, &value);
+                                            case VERI_DIV:
+                                                if (!r || (l == INT_MIN && r == -1))
+                                                    return false;
+                                                value = l / r;
+                                                return true;
+                                            case VERI_MODULUS:
+                                                if (!r || (l == INT_MIN && r == -1))
+                                                    return false;
+                                                value = l % r;
+                                                return true;
+                                            case VERI_LSHIFT:
+                                                if (l < 0 || r < 0 || r > 30 || l > (INT_MAX >> r))
+                                                    return false;
+                                                value = l << r;
+                                                return true;
+                                            case VERI_RSHIFT:
+                                                // Logical shift, exact for non-negative values only
+                                                if (l < 0 || r < 0 || r > 31)
+                                                    return false;
+                                                value = l >> r;
+                                                return true;
+                                            default: return false;
+                                        }
+                                    }
+        case ID_VERIUNARYOPERATOR: {
+                                       VeriUnaryOperator *pOperator = static_cast<VeriUnaryOperator*>(expr);
+                                       int arg;
+                                       if (!foldParamValue(pOperator->GetArg(), arg))
+                                           return false;
+                                       switch (pOperator->OperType()) {
+                                           case VERI_MIN: return !__builtin_sub_overflow(0, arg, &value);
+                                           case VERI_PLUS: value = arg; return true;
+                                           default: return false;
+                                       }
+                                   }
+        case ID_VERIQUESTIONCOLON: {
+                                       VeriQuestionColon *pCond = static_cast<VeriQuestionColon*>(expr);
+                                       int cond;
+                                       if (!foldParamValue(pCond->GetIfExpr(), cond))
+                                           return false;
+                                       return foldParamValue(cond ? pCond->GetThenExpr() : pCond->GetElseExpr(), value);
+                                   }
+        default: {
+                     // Sized and based literals keep their own width and
+                     // sign, they are not folded
+                     return false;
+                 }
+    }
+}
+
 std::vector<std::string> hierDump::getVeriModuleParamList(VeriModuleInstantiation* veriMod) {
     std::vector<std::string> paramList;
     if (!veriMod)
@@ -262,8 +390,7 @@ std::vector<std::string> hierDump::getVeriModuleParamList(VeriModuleInstantiatio
     return paramList;
 }
 
-std::string hierDump::saveVeriModuleInstParamInfo(VeriModuleInstantiation* veriMod, json& module) {
-    std::string paramList;
+void hierDump::saveVeriModuleInstParamInfo(VeriModuleInstantiation* veriMod, json& module, variantTable::tuple& key) {
     unsigned i ;
     VeriExpression *param ;
     std::vector<std::string> list = getVeriModuleParamList(veriMod);
@@ -274,22 +401,17 @@ std::string hierDump::saveVeriModuleInstParamInfo(VeriModuleInstantiation* veriM
             VeriPortConnect *port = static_cast<VeriPortConnect*>(param);
             VeriExpression *connection = port->GetConnection();
             std::string val = getParamValue(connection);
-            paramList.append("_");
-            paramList.append(port->NamedFormal());
-            paramList.append("#");
-            paramList.append(val);
+            key.push_back(variants.intern(port->NamedFormal()));
+            key.push_back(variants.intern(val));
             module.push_back({{"name", port->NamedFormal()}, {"value", val}});
         }
         else if (param->GetClassId() == ID_VERIINTVAL) {
             std::string val = getParamValue(param);
-            paramList.append("_");
-            paramList.append(list[i]);
-            paramList.append("#");
-            paramList.append(val);
+            key.push_back(variants.intern(list[i]));
+            key.push_back(variants.intern(val));
             module.push_back({{"name", list[i]}, {"value", val}});
         }
     }
-    return paramList;
 }
 
 void hierDump::saveVhdlModuleInsts(VhdlPrimaryUnit* mod, json& module) {
@@ -310,18 +432,26 @@ void hierDump::saveVhdlModuleInsts(VhdlPrimaryUnit* mod, json& module) {
                                                                  std::string vFile = lineFile->GetFileName(inst->Linefile());
                                                                  unsigned vLine = lineFile->GetLineNo(inst->StartingLinefile());
                                                                  json params = json::array();
-                                                                 std::string paramList = saveVhdlModuleInstParamInfo(inst, params);
+                                                                 variantTable::tuple key;
+                                                                 saveVhdlModuleInstParamInfo(inst, params, key);
+                                                                 bool added;
+                                                                 unsigned variant = variants.variant(key, added);
                                                                  VhdlLibrary *instLib = vhdl_file::GetLibrary(pStmt->GetLibraryOfInstantiatedUnit(), 1) ;
                                                                  if (!instLib) 
                                                                      instLib = vhdl_file::GetWorkLib() ;
                                                                  VhdlPrimaryUnit* primUnit = instLib ? instLib->GetPrimUnit(pStmt->GetInstantiatedUnitName()) : 0 ;
-                                                                 if (primUnit && primUnit->IsVerilogModule()) { // instance of Verilog module
-                                                                     VeriModule *veriModule = vhdl_file::GetVerilogModuleFromlib(instLib->Name(), primUnit->Name()) ;
-                                                                     SetVeriModuleId(veriModule, paramList);
-                                                                 } else { // Instance of vhdl unit
-                                                                     SetVhdlModuleId(primUnit, paramList);
+                                                                 std::string instName = inst->GetLabel() ? inst->GetLabel()->GetPrettyPrintedString() : "";
+                                                                 hierScope saved;
+                                                                 if (enterInstance(instName, variant, saved)) {
+                                                                     if (primUnit && primUnit->IsVerilogModule()) { // instance of Verilog module
+                                                                         VeriModule *veriModule = vhdl_file::GetVerilogModuleFromlib(instLib->Name(), primUnit->Name()) ;
+                                                                         SetVeriModuleId(veriModule, variant);
+                                                                     } else { // Instance of vhdl unit
+                                                                         SetVhdlModuleId(primUnit, variant);
+                                                                     }
+                                                                     leaveInstance(saved);
                                                                  }
-                                                                 module["moduleInsts"].push_back({{"instName", inst->GetLabel() ? inst->GetLabel()->GetPrettyPrintedString() : ""}, {"file", getFileId(vFile)}, {"line", vLine}, {"parameters", params}, {"module", paramList}});
+                                                                 module["moduleInsts"].push_back({{"instName", instName}, {"file", getFileId(vFile)}, {"line", vLine}, {"parameters", params}, {"module", variants.text(variant)}});
                                                                  break;
                                                              }
                 default: {
@@ -333,10 +463,11 @@ void hierDump::saveVhdlModuleInsts(VhdlPrimaryUnit* mod, json& module) {
     }
 }
 
-void hierDump::SetVhdlModuleId(VhdlPrimaryUnit* unit, std::string paramList) {
+void hierDump::SetVhdlModuleId(VhdlPrimaryUnit* unit, unsigned variant) {
     if (!unit)
         return;
-    if (moduleIDs.find(paramList) == moduleIDs.end()) {
+    if (!isDumped(variant)) {
+        markExpanded(variant);
         json module;
         module["module"] = unit->Name();
         LineFile* lineFile;
@@ -352,41 +483,50 @@ void hierDump::SetVhdlModuleId(VhdlPrimaryUnit* unit, std::string paramList) {
 
         // Thierry : we see potential recursive call (saveVhdlModuleInsts -> 
         // SetVhdlModuleId -> saveVhdlModuleInsts) so we need to add 
-        // "paramList" into "moduleIDs" before caling "saveVhdlModuleInsts"
+        // the variant into the dumped set before caling "saveVhdlModuleInsts"
         // so that we do not re-enter this "if" block in the sub-recursive calls.
         // (but why do we have recursivity with loop here ???)
         //saveVhdlModuleInsts(unit, module);
 
-        modules[paramList] = module;
-        moduleIDs.insert(paramList);
+        saveModule(variants.text(variant), module);
+        setDumped(variant);
 
-        // Thierry : call "saveVhdlModuleInsts" after "moduleIDs.insert(paramList)"
-        // so that we know we already go through here with "paramList" module ID.
+        // Thierry : call "saveVhdlModuleInsts" after "setDumped(variant)"
+        // so that we know we already go through here with this variant.
         //
         saveVhdlModuleInsts(unit, module);
+
+        // The record is saved without its instances, the index gets them
+        // now that they are known
+        indexInstances(variants.text(variant), module);
+    } else if (needsExpansion(variant)) {
+        // Dumped before with less levels left, only the instances are missing
+        json module;
+        saveVhdlModuleInsts(unit, module);
     }
 }
 
-std::string hierDump::saveVhdlModuleInstParamInfo(VhdlComponentInstantiationStatement* mod, json& module) {
-    if (!mod)
-        return "Unknown";
+void hierDump::saveVhdlModuleInstParamInfo(VhdlComponentInstantiationStatement* mod, json& module, variantTable::tuple& key) {
+    if (!mod) {
+        key.push_back(variants.intern("Unknown"));
+        return;
+    }
     VhdlIdDef* unit = mod->GetInstantiatedUnit();
-    std::string paramList = mod->GetInstantiatedUnit() ? mod->GetInstantiatedUnit()->GetPrettyPrintedString() : "";
+    key.push_back(variants.intern(mod->GetInstantiatedUnit() ? mod->GetInstantiatedUnit()->GetPrettyPrintedString() : ""));
     unsigned j ;
     VhdlIdDef *param;
     FOREACH_ARRAY_ITEM(unit->GetGenerics(), j, param) {
         if (!param) continue ;
-        paramList.append("_");
-        paramList.append(param->GetPrettyPrintedString());
-        paramList.append("#");
         std::string exprInitAssign = parseVhdlExpressionStr(param->GetInitAssign());
-        paramList.append(exprInitAssign);
+        key.push_back(variants.intern(param->GetPrettyPrintedString()));
+        key.push_back(variants.intern(exprInitAssign));
         module.push_back({{"name", param->GetPrettyPrintedString()}, {"value", exprInitAssign}});
     }
-    return paramList;
 }
 
 void hierDump::saveVhdlModuleInternalSignals(VhdlPrimaryUnit* mod, json& module, std::unordered_set<std::string>& portNames) {
+    if (signals.active())
+        module["internalSignalCount"] = 0;
     MapIter mi ;
     VhdlSecondaryUnit *sec ;
     FOREACH_VHDL_SECONDARY_UNIT(mod, mi, sec) {
@@ -438,6 +578,8 @@ void hierDump::saveVhdlModuleInternalSignals(VhdlPrimaryUnit* mod, json& module,
                                             FOREACH_ARRAY_ITEM(pSignalDecl->GetIds(), i, pId) {
                                                 if (!pId)
                                                     continue;
+                                                if (!keepSignal(module, pId->Name()))
+                                                    continue;
                                                 json range;
                                                 range["msb"] = msb;
                                                 range["lsb"] = lsb;
@@ -457,6 +599,8 @@ void hierDump::saveVhdlModuleInternalSignals(VhdlPrimaryUnit* mod, json& module,
 void hierDump::saveVeriModuleInternalSignals(VeriModule* veriMod, json& module, std::unordered_set<std::string>& portNames) {
     if (!veriMod)
         return;
+    if (signals.active())
+        module["internalSignalCount"] = 0;
     Array * items = veriMod->GetModuleItems();
     VeriModuleItem *mi ;
     int i;
@@ -476,6 +620,8 @@ void hierDump::saveVeriModuleInternalSignals(VeriModule* veriMod, json& module,
                                       FOREACH_ARRAY_ITEM(dataDecl->GetIds(), j, id_def) {
                                           if (!id_def || portNames.find(id_def->Name()) != portNames.end())
                                               continue ;
+                                          if (!keepSignal(module, id_def->GetName()))
+                                              continue;
                                           json range;
                                           range["msb"] = id_def->LeftRangeBound();
                                           range["lsb"] = id_def->RightRangeBound();
@@ -595,21 +741,478 @@ void hierDump::saveVhdlModulePortsInfo(VhdlPrimaryUnit* mod, json& module, std::
     }
 }
 
-void hierDump::saveInfo(Array* verilogModules, Array* vhdlModules) {
+void hierDump::setHierScope(const std::string& root, int depth) {
+    hierRoot = root;
+    hierDepth = depth;
+    hierScoped = !root.empty() || depth >= 0;
+}
+
+bool hierDump::enterTop(const std::string& name) {
+    if (!hierScoped)
+        return true;
+    if (!hierRoot.empty() && hierRoot != name && hierRoot.compare(0, name.size() + 1, name + ".") != 0)
+        return false;
+    scope.path = name;
+    scope.inRoot = hierRoot.empty() || hierRoot == name;
+    scope.levelsLeft = hierDepth;
+    if (hierRoot == name)
+        rootModule = name;
+    return true;
+}
+
+// Above the root only the instances leading to it are followed, below it
+// as many levels as requested
+bool hierDump::enterInstance(const std::string& name, unsigned variant, hierScope& saved) {
+    if (!hierScoped)
+        return true;
+    saved = scope;
+    std::string path = scope.path + "." + name;
+    if (scope.inRoot) {
+        if (scope.levelsLeft == 0)
+            return false;
+        if (scope.levelsLeft > 0)
+            scope.levelsLeft--;
+    } else if (hierRoot == path) {
+        scope.inRoot = true;
+        scope.levelsLeft = hierDepth;
+        rootModule = variants.text(variant);
+    } else if (hierRoot.compare(0, path.size() + 1, path + ".") != 0) {
+        return false;
+    }
+    scope.path = path;
+    return true;
+}
+
+// How deep the instances of a module are dumped from the current scope:
+// -1 for a module above the root, where only the path to it is followed
+int hierDump::expansionLevel() const {
+    if (!scope.inRoot)
+        return -1;
+    return scope.levelsLeft < 0 ? std::numeric_limits<int>::max() : scope.levelsLeft;
+}
+
+void hierDump::markExpanded(unsigned variant) {
+    if (hierScoped)
+        expandedLevels[variant] = expansionLevel();
+}
+
+bool hierDump::needsExpansion(unsigned variant) {
+    if (!hierScoped)
+        return false;
+    int level = expansionLevel();
+    auto it = expandedLevels.find(variant);
+    if (it != expandedLevels.end() && it->second >= level)
+        return false;
+    expandedLevels[variant] = level;
+    return true;
+}
+
+// ------------------------------
+// saveInfo
+// ------------------------------
+// The port records of the top modules are taken from the same walk. They
+// are collected per language, port_info lists the VHDL tops first.
+void hierDump::saveInfo(Array* verilogModules, Array* vhdlModules, portDump* ports) {
+    std::vector<json> veriPorts;
+    std::vector<json> vhdlPorts;
+    // The parameters of another elaboration may reuse the same addresses
+    paramValues.clear();
+    paramInts.clear();
+    topPorts = &veriPorts;
     saveVeriInfo(verilogModules, tree);
+    topPorts = &vhdlPorts;
     saveVhdlInfo(vhdlModules, tree);
+    topPorts = nullptr;
+    if (!ports)
+        return;
+    for (auto& record : vhdlPorts)
+        ports->savePortRecord(record);
+    for (auto& record : veriPorts)
+        ports->savePortRecord(record);
+}
+
+void hierDump::saveTopPorts(const json& module) {
+    if (!topPorts)
+        return;
+    json record;
+    record["topModule"] = module["topModule"];
+    if (module.contains("ports"))
+        record["ports"] = module["ports"];
+    topPorts->push_back(record);
+}
+
+void hierDump::setFormat(outputFormat value) {
+    portDump::setFormat(value);
+    modules.setFormat(value);
+    tree.setFormat(value);
+    addedModules.setFormat(value);
+    changedModules.setFormat(value);
+    addedTops.setFormat(value);
+    changedTops.setFormat(value);
+}
+
+void hierDump::setThreadPool(threadPool* pool) {
+    portDump::setThreadPool(pool);
+    modules.setThreadPool(pool);
+    tree.setThreadPool(pool);
+    addedModules.setThreadPool(pool);
+    changedModules.setThreadPool(pool);
+    addedTops.setThreadPool(pool);
+    changedTops.setThreadPool(pool);
+}
+
+// ------------------------------
+// keepSignal
+// ------------------------------
+// Counts the signal and tells whether it passes the filters
+bool hierDump::keepSignal(json& module, const std::string& name) {
+    if (!signals.active())
+        return true;
+    module["internalSignalCount"] = module["internalSignalCount"].get<int>() + 1;
+    if (signals.skipGenerated && (name.compare(0, 6, "genblk") == 0 || name[0] == '_' ||
+                name[0] == '\\' || name.find('$') != std::string::npos))
+        return false;
+    if (!signals.includes.empty() && std::none_of(signals.includes.begin(), signals.includes.end(),
+                [&name](const std::regex& re) { return std::regex_search(name, re); }))
+        return false;
+    for (auto& re : signals.excludes) {
+        if (std::regex_search(name, re))
+            return false;
+    }
+    if (signals.maxCount >= 0 && module.contains("internalSignals") &&
+            (int)module["internalSignals"].size() >= signals.maxCount)
+        return false;
+    return signals.maxCount != 0;
+}
+
+// ------------------------------
+// saveModule
+// ------------------------------
+// The digest covers everything but the module name, so variants of
+// different modules can share a body as well
+void hierDump::saveModule(const std::string& key, const json& module) {
+    if (modules.contains(key))
+        return;
+    indexRecord(key, module);
+    if (!dedup) {
+        modules.insert(key, module);
+        trackDelta("modules", key, module, moduleDigests, &addedModules, &changedModules);
+        return;
+    }
+    json body = module;
+    body.erase("module");
+    contentHash hash;
+    hash.add(body.dump());
+    auto res = bodies.emplace(hash.hex(), key);
+    if (res.second) {
+        modules.insert(key, module);
+        trackDelta("modules", key, module, moduleDigests, &addedModules, &changedModules);
+    } else {
+        json shared = {{"module", module["module"]}, {"sameAs", res.first->second}};
+        modules.insert(key, shared);
+        trackDelta("modules", key, shared, moduleDigests, &addedModules, &changedModules);
+        sharedVariants++;
+    }
+}
+
+void hierDump::saveTop(const json& module) {
+    tree.append(module);
+    if (indexed) {
+        std::string name = module["topModule"];
+        indexTops.push_back(name);
+        indexRecord(name, module);
+    }
+    trackDelta("hierTree", module["topModule"].get<std::string>(), module, topDigests, &addedTops, &changedTops);
+}
+
+void hierDump::savePartial(std::ostream& out) {
+    json ids = json::object();
+    for (auto& id : fileIDs)
+        ids[id.second] = id.first;
+    out << json({{"fileIDs", ids}}).dump() << '\n';
+    if (!rootModule.empty())
+        out << json({{"hierRoot", rootModule}}).dump() << '\n';
+    tree.forEach([&out](const std::string&, const json& record) {
+            out << json({{"top", record}}).dump() << '\n';
+            });
+    modules.forEach([&out](const std::string& key, const json& record) {
+            out << json({{"module", key}, {"record", record}}).dump() << '\n';
+            });
+    // VHDL records do not list their instances, the links of every record
+    // follow the records
+    for (auto& links : instanceLinks) {
+        json insts = json::array();
+        for (auto& link : links.second)
+            insts.push_back({{"instName", link.name}, {"module", link.module}});
+        out << json({{"links", links.first}, {"moduleInsts", insts}}).dump() << '\n';
+    }
+}
+
+// ------------------------------
+// mergePartial
+// ------------------------------
+// The file table of a worker comes first. Its files are numbered here in
+// the order the worker numbered them, which gives the IDs a single process
+// dumping the libraries one after the other would have given.
+void hierDump::mergePartial(const json& line) {
+    if (line.contains("fileIDs")) {
+        std::map<int, std::string> byId;
+        for (auto& id : line["fileIDs"].items())
+            byId[std::stoi(id.key())] = id.value();
+        partialFileIDs.clear();
+        for (auto& id : byId)
+            partialFileIDs[std::to_string(id.first)] = getFileId(id.second);
+    } else if (line.contains("hierRoot")) {
+        if (rootModule.empty())
+            rootModule = line["hierRoot"];
+    } else if (line.contains("top")) {
+        json record = line["top"];
+        remapFileIds(record);
+        saveTop(record);
+    } else if (line.contains("module")) {
+        json record = line["record"];
+        remapFileIds(record);
+        saveModule(line["module"], record);
+    } else if (line.contains("links")) {
+        indexInstances(line["links"], line);
+    }
+}
+
+void hierDump::remapFileIds(json& record) {
+    auto remap = [this](json& item) {
+        if (!item.is_object() || !item.contains("file"))
+            return;
+        auto id = partialFileIDs.find(item["file"].get<std::string>());
+        if (id != partialFileIDs.end())
+            item["file"] = id->second;
+    };
+    remap(record);
+    if (record.contains("moduleInsts") && record["moduleInsts"].is_array()) {
+        for (auto& inst : record["moduleInsts"])
+            remap(inst);
+    }
+}
+
+// ------------------------------
+// indexRecord
+// ------------------------------
+// Only the instance links are kept, the paths are expanded when the index
+// is written since a variant is dumped once however often it is used
+void hierDump::indexRecord(const std::string& key, const json& record) {
+    if (!indexed || instanceLinks.count(key))
+        return;
+    indexInstances(key, record);
+    if (record.contains("file"))
+        fileModules[record["file"]].insert(key);
+}
+
+void hierDump::indexInstances(const std::string& key, const json& record) {
+    if (!indexed)
+        return;
+    std::vector<instanceLink>& links = instanceLinks[key];
+    links.clear();
+    if (record.contains("moduleInsts") && record["moduleInsts"].is_array()) {
+        for (auto& inst : record["moduleInsts"])
+            links.push_back({inst["instName"], inst["module"]});
+    }
+}
+
+json hierDump::buildIndex() {
+    std::map<std::string, std::string> instances;
+    std::map<std::string, std::set<std::string>> paths;
+    std::set<std::string> onPath;
+    std::function<void(const std::string&, const std::string&)> visit =
+        [&](const std::string& path, const std::string& module) {
+            instances[path] = module;
+            paths[module].insert(path);
+            auto links = instanceLinks.find(module);
+            // A variant instantiating itself cannot be elaborated, but the
+            // keys merge same-named modules, so guard against loops anyway
+            if (links == instanceLinks.end() || !onPath.insert(module).second)
+                return;
+            for (auto& link : links->second)
+                visit(path + "." + link.name, link.module);
+            onPath.erase(module);
+        };
+    for (auto& top : indexTops)
+        visit(top, top);
+
+    json index;
+    index["instances"] = instances;
+    index["modules"] = paths;
+    index["files"] = fileModules;
+    return index;
+}
+
+void hierDump::setDelta(const std::string& file) {
+    digestFile = file;
+    previousDigests = json::object();
+    std::ifstream in(digestFile);
+    if (!in) {
+        std::cout << "INFO: No digests in " << digestFile << ", the delta holds the whole hierarchy." << std::endl;
+        return;
+    }
+    try {
+        previousDigests = json::parse(in);
+    } catch (const json::exception&) {
+        std::cout << "WARNING: Could not read " << digestFile << ", the delta holds the whole hierarchy." << std::endl;
+        previousDigests = json::object();
+    }
+}
+
+// ------------------------------
+// trackDelta
+// ------------------------------
+// Records are compared when they are saved, so that only the added and
+// changed ones have to be kept for the delta
+void hierDump::trackDelta(const std::string& section, const std::string& key, const json& record,
+        std::map<std::string, std::string>& digests, jsonSpool* added, jsonSpool* changed) {
+    if (digestFile.empty() || digests.count(key))
+        return;
+    contentHash hash;
+    hash.add(record.dump());
+    std::string digest = hash.hex();
+    digests[key] = digest;
+    auto previous = previousDigests.find(section);
+    if (previous == previousDigests.end() || !previous->contains(key)) {
+        if (section == "modules")
+            added->insert(key, record);
+        else
+            added->append(record);
+    } else if ((*previous)[key] != digest) {
+        if (section == "modules")
+            changed->insert(key, record);
+        else
+            changed->append(record);
+    }
+}
+
+// ------------------------------
+// saveDelta
+// ------------------------------
+// Same layout as the full file, with each section split into added,
+// changed (both with the new records) and removed (the keys or top
+// module names only)
+void hierDump::saveDelta(const std::map<std::string, std::string>& fileMap) {
+    std::string deltaFile = "hier_info_delta" + outputExtension(format);
+    std::ofstream o(deltaFile, std::ios::binary);
+    jsonWriter writer(o, format);
+    auto removed = [this](const std::string& section, const std::map<std::string, std::string>& digests) {
+        json keys = json::array();
+        auto previous = previousDigests.find(section);
+        if (previous != previousDigests.end() && previous->is_object()) {
+            for (auto& entry : previous->items()) {
+                if (!digests.count(entry.key()))
+                    keys.push_back(entry.key());
+            }
+        }
+        return keys;
+    };
+    writer.beginObject(3);
+    writer.key("fileIDs");
+    writer.value(fileMap);
+    writer.key("hierTree");
+    writer.beginObject(3);
+    writer.key("added");
+    writer.beginArray(addedTops.size());
+    writer.elements(addedTops);
+    writer.endArray();
+    writer.key("changed");
+    writer.beginArray(changedTops.size());
+    writer.elements(changedTops);
+    writer.endArray();
+    writer.key("removed");
+    writer.value(removed("hierTree", topDigests));
+    writer.endObject();
+    writer.key("modules");
+    writer.beginObject(3);
+    writer.key("added");
+    writer.beginObject(addedModules.size());
+    writer.members(addedModules);
+    writer.endObject();
+    writer.key("changed");
+    writer.beginObject(changedModules.size());
+    writer.members(changedModules);
+    writer.endObject();
+    writer.key("removed");
+    writer.value(removed("modules", moduleDigests));
+    writer.endObject();
+    writer.endObject();
+    if (format == outputFormat::json || format == outputFormat::compactJson)
+        o << std::endl;
+
+    json digests;
+    digests["modules"] = moduleDigests;
+    digests["hierTree"] = topDigests;
+    std::ofstream d(digestFile);
+    d << digests.dump() << std::endl;
+    std::cout << "INFO: Delta against the previous run: " << addedModules.size() + addedTops.size()
+        << " added, " << changedModules.size() + changedTops.size() << " changed records, written to "
+        << deltaFile << "." << std::endl;
 }
 
 void hierDump::saveJson() {
-    json fileMap;
+    std::map<std::string, std::string> fileMap;
     for (auto id : fileIDs) {
         fileMap[id.second] = id.first;
     }
 
-    json result;
-    result["fileIDs"] = fileMap;
-    result["modules"] = modules;
-    result["hierTree"] = tree;
-    std::ofstream o(file);
-    o << std::setw(4) << result << std::endl;
+    // Sections never filled are written as null, like the empty json values
+    // they used to be
+    std::ofstream o(file, std::ios::binary);
+    jsonWriter writer(o, format);
+    writer.beginObject(3 + (hierScoped ? 1 : 0) + (indexed ? 1 : 0));
+    writer.key("fileIDs");
+    if (fileMap.empty()) {
+        writer.value(nullptr);
+    } else {
+        writer.beginObject(fileMap.size());
+        for (auto& id : fileMap) {
+            writer.key(id.first);
+            writer.value(id.second);
+        }
+        writer.endObject();
+    }
+    if (dedup)
+        std::cout << "INFO: " << sharedVariants << " of " << modules.size()
+            << " module variants share the body of another one." << std::endl;
+    if (hierScoped && !hierRoot.empty() && rootModule.empty())
+        std::cout << "WARNING: -hier-root " << hierRoot << " was not found in the hierarchy." << std::endl;
+    if (hierScoped) {
+        json root;
+        root["path"] = hierRoot;
+        root["depth"] = hierDepth;
+        if (rootModule.empty())
+            root["module"] = nullptr;
+        else
+            root["module"] = rootModule;
+        writer.key("hierRoot");
+        writer.value(root);
+    }
+    writer.key("hierTree");
+    if (tree.empty()) {
+        writer.value(nullptr);
+    } else {
+        writer.beginArray(tree.size());
+        writer.elements(tree);
+        writer.endArray();
+    }
+    if (indexed) {
+        writer.key("index");
+        writer.value(buildIndex());
+    }
+    writer.key("modules");
+    if (modules.empty()) {
+        writer.value(nullptr);
+    } else {
+        writer.beginObject(modules.size());
+        writer.members(modules);
+        writer.endObject();
+    }
+    writer.endObject();
+    if (format == outputFormat::json || format == outputFormat::compactJson)
+        o << std::endl;
+
+    if (!digestFile.empty())
+        saveDelta(fileMap);
 }
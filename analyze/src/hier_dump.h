@@ -16,6 +16,10 @@
 #include <unordered_set>
 #include <set>
 #include <vector>
+#include <limits>
+#include <climits>
+#include <functional>
+#include <regex>
 
 #include <nlohmann_json/json.hpp>
 
@@ -37,23 +41,38 @@
 #include "file_sort_vhdl_tokens.h"
 #include "hdl_file_sort.h"
 #include "port_dump.h"
+#include "variant_table.h"
 
 using namespace Verific ;
 using json = nlohmann::json;
 
 class hierDump : public portDump {
     public:
+        // Selection of the internal signals written per module. When any
+        // filter is set the records also get the number of internal signals
+        // found before filtering.
+        struct signalFilter {
+            std::vector<std::regex> includes;   // kept if one matches, all when empty
+            std::vector<std::regex> excludes;
+            int maxCount = -1;                  // per module variant, -1 for no limit
+            bool skipGenerated = false;         // genblk*, _*, escaped names and names with '$'
+
+            bool active() const {
+                return !includes.empty() || !excludes.empty() || maxCount >= 0 || skipGenerated;
+            }
+        };
+
         hierDump(std::string fileName): portDump(fileName) {}
 
         std::string getVeriMode(int mode);
 
         std::string getVhdlMode(int mode);
 
-        void saveVeriInfo(Array *verilogModules, json& hierInfo);
+        void saveVeriInfo(Array *verilogModules, jsonSpool& hierInfo);
 
-        void saveVhdlInfo(Array *vhdlModules, json& hierInfo);
+        void saveVhdlInfo(Array *vhdlModules, jsonSpool& hierInfo);
 
-        void SetVeriModuleId(VeriModule* veri_mod, std::string paramList);
+        void SetVeriModuleId(VeriModule* veri_mod, unsigned variant);
 
         std::string getFileId(std::string fileName);
 
@@ -63,7 +82,7 @@ class hierDump : public portDump {
 
         std::string getParamValue(VeriExpression *connection);
 
-        std::string saveVeriModuleInstParamInfo(VeriModuleInstantiation* veriMod, json& module);
+        void saveVeriModuleInstParamInfo(VeriModuleInstantiation* veriMod, json& module, variantTable::tuple& key);
 
         std::vector<std::string> getVeriModuleParamList(VeriModuleInstantiation* veriMod);
 
@@ -79,19 +98,138 @@ class hierDump : public portDump {
 
         void saveVhdlModuleInsts(VhdlPrimaryUnit* mod, json& module);
 
-        std::string saveVhdlModuleInstParamInfo(VhdlComponentInstantiationStatement* mod, json& module);
+        void saveVhdlModuleInstParamInfo(VhdlComponentInstantiationStatement* mod, json& module, variantTable::tuple& key);
+
+        void SetVhdlModuleId(VhdlPrimaryUnit* mod, unsigned variant);
+
+        // Also adds the port records of the top modules to ports, when given
+        void saveInfo(Array* verilogModules, Array* vhdlModules, portDump* ports = nullptr);
+
+        void setFormat(outputFormat value);
+
+        void setThreadPool(threadPool* pool);
+
+        // Limits the dump to the instances below root (a "top.inst.inst"
+        // path, empty for all tops) and to depth levels of instances below
+        // it (-1 for no limit)
+        void setHierScope(const std::string& root, int depth);
+
+        // Variants with the same contents as an earlier one are written as a
+        // reference to it
+        void setDedup(bool value) { dedup = value; }
+
+        // Compares the records with the digests of the previous run stored in
+        // digestFile, writes the differences to hier_info_delta.json and
+        // replaces the digests with the ones of this run
+        void setDelta(const std::string& digestFile);
 
-        void SetVhdlModuleId(VhdlPrimaryUnit* mod, std::string paramList);
+        // Adds an index section: instance paths of every module variant,
+        // module variant of every instance path, module variants of every file
+        void setIndexed(bool value) { indexed = value; }
 
-        void saveInfo(Array* verilogModules, Array* vhdlModules);
+        void setSignalFilter(const signalFilter& filter) { signals = filter; }
 
         void saveJson();
 
+        // Records of a worker process dumping one library, see portDump
+        void savePartial(std::ostream& out);
+
+        void mergePartial(const json& line);
+
     private:
+        struct hierScope {
+            std::string path;
+            bool inRoot = true;
+            int levelsLeft = -1;
+        };
+
+        bool enterTop(const std::string& name);
+
+        bool enterInstance(const std::string& name, unsigned variant, hierScope& saved);
+
+        void leaveInstance(const hierScope& saved) { scope = saved; }
+
+        int expansionLevel() const;
+
+        void markExpanded(unsigned variant);
+
+        bool needsExpansion(unsigned variant);
+
+        // Value of a constant expression over integer literals and integer
+        // parameters, false when it is not one or it is not exactly a
+        // 32-bit signed value
+        bool foldParamValue(VeriExpression *expr, int& value);
+
+        void saveModule(const std::string& key, const json& module);
+
+        bool keepSignal(json& module, const std::string& name);
+
+        void saveTopPorts(const json& module);
+
+        void remapFileIds(json& record);
+
+        void indexRecord(const std::string& key, const json& record);
+
+        // Replaces the instance links of key by the instances of record
+        void indexInstances(const std::string& key, const json& record);
+
+        json buildIndex();
+
+        void saveTop(const json& module);
+
+        void trackDelta(const std::string& section, const std::string& key, const json& record,
+                std::map<std::string, std::string>& digests, jsonSpool* added, jsonSpool* changed);
+
+        void saveDelta(const std::map<std::string, std::string>& fileMap);
+
+        bool hierScoped = false;
+        std::string hierRoot;
+        int hierDepth = -1;
+        hierScope scope;
+        std::string rootModule;
+        std::unordered_map<unsigned, int> expandedLevels;
+
         std::unordered_map<std::string, std::string> fileIDs;
-        std::unordered_set<std::string> moduleIDs;
-        json modules;
-        json tree;
+        std::unordered_map<std::string, std::string> partialFileIDs;   // worker ID -> ID
+        bool isDumped(unsigned variant) const { return variant < dumped.size() && dumped[variant]; }
+
+        void setDumped(unsigned variant) {
+            if (dumped.size() <= variant)
+                dumped.resize(variants.size());
+            dumped[variant] = true;
+        }
+
+        variantTable variants;
+        std::unordered_map<const VeriIdDef*, std::string> paramValues;    // evaluated once per elaboration
+        std::unordered_map<const VeriIdDef*, std::pair<bool, int>> paramInts;    // folded value, false when not exact
+        std::vector<bool> dumped;
+        bool dedup = false;
+        std::unordered_map<std::string, std::string> bodies;    // digest -> variant holding it
+        size_t sharedVariants = 0;
+
+        struct instanceLink {
+            std::string name;
+            std::string module;
+        };
+
+        signalFilter signals;
+        std::vector<json>* topPorts = nullptr;
+
+        bool indexed = false;
+        std::unordered_map<std::string, std::vector<instanceLink>> instanceLinks;
+        std::vector<std::string> indexTops;
+        std::map<std::string, std::set<std::string>> fileModules;
+
+        std::string digestFile;     // empty when no delta is written
+        json previousDigests;
+        std::map<std::string, std::string> moduleDigests;
+        std::map<std::string, std::string> topDigests;
+        jsonSpool addedModules{3};
+        jsonSpool changedModules{3};
+        jsonSpool addedTops{3};
+        jsonSpool changedTops{3};
+        jsonSpool modules{2};
+        jsonSpool tree{2};
 };
 
 #endif
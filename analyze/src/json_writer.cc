@@ -0,0 +1,329 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#include <random>
+
+#include "json_writer.h"
+#include "thread_pool.h"
+
+static const int indentSize = 4;
+
+// Records serialized per task, and tasks queued per thread before adding
+// records waits for the oldest batch
+static const size_t batchSize = 64;
+static const size_t batchesPerThread = 4;
+
+std::string outputExtension(outputFormat format) {
+    switch (format) {
+        case outputFormat::cbor    : return ".cbor";
+        case outputFormat::msgpack : return ".msgpack";
+        default                    : return ".json";
+    }
+}
+
+// ------------------------------
+// dumpAtDepth
+// ------------------------------
+// Literal newlines only separate structure in dumped JSON, strings have them
+// escaped, so nesting a dumped value is a matter of indenting every new line.
+static std::string dumpAtDepth(const json& value, int depth, outputFormat format) {
+    if (format == outputFormat::cbor) {
+        std::string res;
+        json::to_cbor(value, nlohmann::detail::output_adapter<char>(res));
+        return res;
+    }
+    if (format == outputFormat::msgpack) {
+        std::string res;
+        json::to_msgpack(value, nlohmann::detail::output_adapter<char>(res));
+        return res;
+    }
+    if (format == outputFormat::compactJson)
+        return value.dump();
+    std::string text = value.dump(indentSize);
+    if (depth == 0)
+        return text;
+    std::string indent(depth * indentSize, ' ');
+    std::string res;
+    res.reserve(text.size() + text.size() / 8);
+    for (char c : text) {
+        res += c;
+        if (c == '\n')
+            res += indent;
+    }
+    return res;
+}
+
+jsonSpool::jsonSpool(int depth): depth(depth) {
+    std::random_device rd;
+    spoolFile = std::filesystem::temp_directory_path() /
+        ("analyze_spool_" + std::to_string(rd()) + std::to_string(rd()));
+}
+
+jsonSpool::~jsonSpool() {
+    // The tasks still running refer to the batches
+    for (auto& pending : inFlight)
+        pending.texts.wait();
+    if (spool.is_open())
+        spool.close();
+    std::error_code ec;
+    std::filesystem::remove(spoolFile, ec);
+}
+
+jsonSpool::location jsonSpool::store(const json& record) {
+    return storeText(dumpAtDepth(record, depth, format));
+}
+
+jsonSpool::location jsonSpool::storeText(const std::string& text) {
+    if (!spool.is_open()) {
+        spool.open(spoolFile, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!spool)
+            throw std::runtime_error("Could not create spool file " + spoolFile.string());
+    }
+    spool.seekp(spoolSize);
+    spool.write(text.data(), text.size());
+    // A full disk must not end up as missing records in the output
+    if (spool.fail())
+        throw std::runtime_error("Could not write spool file " + spoolFile.string());
+    location loc = {spoolSize, text.size()};
+    spoolSize += text.size();
+    return loc;
+}
+
+void jsonSpool::append(const json& record) {
+    if (pool) {
+        elements.push_back({0, 0});
+        queue(record, {elements.size() - 1, nullptr});
+        return;
+    }
+    elements.push_back(store(record));
+}
+
+void jsonSpool::insert(const std::string& key, const json& record) {
+    if (members.find(key) != members.end())
+        return;
+    if (pool) {
+        // std::map nodes do not move, the location is filled in later
+        location& loc = members[key];
+        queue(record, {0, &loc});
+        return;
+    }
+    members[key] = store(record);
+}
+
+void jsonSpool::queue(const json& record, slot target) {
+    current.records.push_back(record);
+    current.slots.push_back(target);
+    if (current.records.size() >= batchSize)
+        submit();
+}
+
+// ------------------------------
+// submit
+// ------------------------------
+// Batches are stored as they complete, oldest first, so the spool file has
+// the records in the order they were added whatever thread serialized them
+void jsonSpool::submit() {
+    if (current.records.empty())
+        return;
+    inFlight.push_back(std::move(current));
+    current = batch();
+    const std::vector<json>* records = &inFlight.back().records;
+    int recordDepth = depth;
+    outputFormat recordFormat = format;
+    inFlight.back().texts = pool->submit([records, recordDepth, recordFormat]() {
+            std::vector<std::string> texts;
+            texts.reserve(records->size());
+            for (auto& record : *records)
+                texts.push_back(dumpAtDepth(record, recordDepth, recordFormat));
+            return texts;
+            });
+    while (!inFlight.empty()) {
+        bool full = inFlight.size() > batchesPerThread * pool->size();
+        if (!full && inFlight.front().texts.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            break;
+        storeBatch(inFlight.front());
+        inFlight.pop_front();
+    }
+}
+
+void jsonSpool::storeBatch(batch& done) {
+    std::vector<std::string> texts = done.texts.get();
+    for (size_t i = 0; i < texts.size(); i++) {
+        location loc = storeText(texts[i]);
+        if (done.slots[i].member)
+            *done.slots[i].member = loc;
+        else
+            elements[done.slots[i].element] = loc;
+    }
+}
+
+void jsonSpool::finish() {
+    if (pool) {
+        submit();
+        while (!inFlight.empty()) {
+            storeBatch(inFlight.front());
+            inFlight.pop_front();
+        }
+    }
+    // Buffered records reach the file here, before they are read back
+    if (spool.is_open() && !spool.flush())
+        throw std::runtime_error("Could not write spool file " + spoolFile.string());
+}
+
+void jsonSpool::copyRecord(size_t offset, size_t size, std::ostream& out) {
+    spool.seekg(offset);
+    std::string buffer(size, '\0');
+    spool.read(&buffer[0], size);
+    if (spool.fail())
+        throw std::runtime_error("Could not read spool file " + spoolFile.string());
+    out.write(buffer.data(), size);
+}
+
+json jsonSpool::readRecord(const location& loc) {
+    spool.seekg(loc.offset);
+    std::string buffer(loc.size, '\0');
+    spool.read(&buffer[0], loc.size);
+    if (spool.fail())
+        throw std::runtime_error("Could not read spool file " + spoolFile.string());
+    if (format == outputFormat::cbor)
+        return json::from_cbor(buffer);
+    if (format == outputFormat::msgpack)
+        return json::from_msgpack(buffer);
+    return json::parse(buffer);
+}
+
+void jsonSpool::forEach(const std::function<void(const std::string& key, const json& record)>& fn) {
+    finish();
+    for (auto& loc : elements)
+        fn("", readRecord(loc));
+    for (auto& member : members)
+        fn(member.first, readRecord(member.second));
+}
+
+void jsonWriter::newline() {
+    if (format != outputFormat::json)
+        return;
+    out << '\n' << std::string(levels.size() * indentSize, ' ');
+}
+
+void jsonWriter::separator() {
+    if (levels.empty() || binary())
+        return;
+    level& top = levels.back();
+    if (!top.first)
+        out << ',';
+    top.first = false;
+    newline();
+}
+
+// ------------------------------
+// containerHeader
+// ------------------------------
+// Definite length array/map header, in the shortest form, as nlohmann writes it
+void jsonWriter::containerHeader(bool isArray, size_t count) {
+    auto bigEndian = [this](uint64_t value, int bytes) {
+        for (int i = bytes - 1; i >= 0; i--)
+            out.put((char)((value >> (8 * i)) & 0xFF));
+    };
+    if (format == outputFormat::cbor) {
+        uint8_t major = isArray ? 0x80 : 0xA0;
+        if (count < 24) {
+            out.put((char)(major | count));
+        } else if (count <= 0xFF) {
+            out.put((char)(major | 24));
+            bigEndian(count, 1);
+        } else if (count <= 0xFFFF) {
+            out.put((char)(major | 25));
+            bigEndian(count, 2);
+        } else if (count <= 0xFFFFFFFF) {
+            out.put((char)(major | 26));
+            bigEndian(count, 4);
+        } else {
+            out.put((char)(major | 27));
+            bigEndian(count, 8);
+        }
+        return;
+    }
+    if (count <= 15) {
+        out.put((char)((isArray ? 0x90 : 0x80) | count));
+    } else if (count <= 0xFFFF) {
+        out.put((char)(isArray ? 0xDC : 0xDE));
+        bigEndian(count, 2);
+    } else {
+        out.put((char)(isArray ? 0xDD : 0xDF));
+        bigEndian(count, 4);
+    }
+}
+
+void jsonWriter::beginObject(size_t count) {
+    if (!levels.empty() && levels.back().isArray)
+        separator();
+    if (binary())
+        containerHeader(false, count);
+    else
+        out << '{';
+    levels.push_back({false, true});
+}
+
+void jsonWriter::endObject() {
+    bool empty = levels.back().first;
+    levels.pop_back();
+    if (binary())
+        return;
+    if (!empty)
+        newline();
+    out << '}';
+}
+
+void jsonWriter::beginArray(size_t count) {
+    if (!levels.empty() && levels.back().isArray)
+        separator();
+    if (binary())
+        containerHeader(true, count);
+    else
+        out << '[';
+    levels.push_back({true, true});
+}
+
+void jsonWriter::endArray() {
+    bool empty = levels.back().first;
+    levels.pop_back();
+    if (binary())
+        return;
+    if (!empty)
+        newline();
+    out << ']';
+}
+
+void jsonWriter::key(const std::string& name) {
+    separator();
+    if (binary())
+        out << dumpAtDepth(name, 0, format);
+    else
+        out << json(name).dump() << (format == outputFormat::compactJson ? ":" : ": ");
+}
+
+void jsonWriter::value(const json& value) {
+    if (!levels.empty() && levels.back().isArray)
+        separator();
+    out << dumpAtDepth(value, levels.size(), format);
+}
+
+void jsonWriter::elements(jsonSpool& spool) {
+    spool.finish();
+    for (auto& loc : spool.elements) {
+        separator();
+        spool.copyRecord(loc.offset, loc.size, out);
+    }
+}
+
+void jsonWriter::members(jsonSpool& spool) {
+    spool.finish();
+    for (auto& member : spool.members) {
+        key(member.first);
+        spool.copyRecord(member.second.offset, member.second.size, out);
+    }
+}
@@ -0,0 +1,170 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <deque>
+#include <future>
+
+#include <nlohmann_json/json.hpp>
+
+using json = nlohmann::json;
+
+class threadPool;
+
+// Encoding of the output files. The binary formats carry the same document
+// as the JSON text, as produced by json::to_cbor/json::to_msgpack.
+enum class outputFormat { json, compactJson, cbor, msgpack };
+
+// File extension used for a format, with the leading dot
+std::string outputExtension(outputFormat format);
+
+// Records of one section of an output file (top modules, module variants).
+// A record is serialized as soon as it is complete, at the indentation it
+// will have in the final file, and parked in a temporary file, so only the
+// record being built is kept in memory.
+class jsonSpool {
+    public:
+        // depth: number of containers enclosing the records in the output
+        jsonSpool(int depth);
+
+        ~jsonSpool();
+
+        jsonSpool(const jsonSpool&) = delete;
+
+        jsonSpool& operator=(const jsonSpool&) = delete;
+
+        // Must be set before the first record is added
+        void setFormat(outputFormat value) { format = value; }
+
+        // Records are then serialized by the pool, in batches, and stored in
+        // the order they were added
+        void setThreadPool(threadPool* value) { pool = value; }
+
+        // Waits for the records being serialized and writes out the spool,
+        // throws std::runtime_error when the spool file cannot be written
+        void finish();
+
+        // Record of an array section, kept in insertion order
+        void append(const json& record);
+
+        // Record of an object section, kept in key order. The first record
+        // stored for a key wins.
+        void insert(const std::string& key, const json& record);
+
+        bool contains(const std::string& key) const { return members.count(key) > 0; }
+
+        // Reads the records back, in output order. key is empty for the
+        // records of an array section.
+        void forEach(const std::function<void(const std::string& key, const json& record)>& fn);
+
+        bool empty() const { return elements.empty() && members.empty(); }
+
+        size_t size() const { return elements.size() + members.size(); }
+
+    private:
+        friend class jsonWriter;
+
+        struct location {
+            size_t offset;
+            size_t size;
+        };
+
+        // Where a serialized record goes: an element or a member
+        struct slot {
+            size_t element;
+            location* member;
+        };
+
+        struct batch {
+            std::vector<json> records;
+            std::vector<slot> slots;
+            std::future<std::vector<std::string>> texts;
+        };
+
+        location store(const json& record);
+
+        location storeText(const std::string& text);
+
+        void queue(const json& record, slot target);
+
+        void submit();
+
+        void storeBatch(batch& done);
+
+        void copyRecord(size_t offset, size_t size, std::ostream& out);
+
+        json readRecord(const location& loc);
+
+        int depth;
+        outputFormat format = outputFormat::json;
+        std::filesystem::path spoolFile;
+        std::fstream spool;
+        size_t spoolSize = 0;
+        std::vector<location> elements;
+        std::map<std::string, location> members;
+        threadPool* pool = nullptr;
+        batch current;
+        std::deque<batch> inFlight;
+};
+
+// Writes a JSON document piece by piece with the same layout as
+// "out << std::setw(4) << document" (or a plain dump in compact mode), or
+// with the same bytes as the binary encoding of the whole document. The
+// binary formats need the number of members up front.
+class jsonWriter {
+    public:
+        jsonWriter(std::ostream& out, outputFormat format): out(out), format(format) {}
+
+        void beginObject(size_t count);
+
+        void endObject();
+
+        void beginArray(size_t count);
+
+        void endArray();
+
+        void key(const std::string& name);
+
+        void value(const json& value);
+
+        // Records of the spool as the elements of the current array
+        void elements(jsonSpool& spool);
+
+        // Records of the spool as the members of the current object
+        void members(jsonSpool& spool);
+
+        // Current nesting, to be used as the depth of the spools written here
+        int depth() const { return levels.size(); }
+
+    private:
+        struct level {
+            bool isArray;
+            bool first;
+        };
+
+        void separator();
+
+        void newline();
+
+        void containerHeader(bool isArray, size_t count);
+
+        bool binary() const { return format == outputFormat::cbor || format == outputFormat::msgpack; }
+
+        std::ostream& out;
+        outputFormat format;
+        std::vector<level> levels;
+};
+
+#endif
@@ -0,0 +1,56 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#ifndef OUTPUT_READER_H
+#define OUTPUT_READER_H
+
+// Reading and writing port_info/hier_info files in any of the output
+// formats, selected by the file extension (.json, .cbor, .msgpack). Header
+// only, tools consuming the analyze output need nothing but nlohmann json.
+
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+#include <nlohmann_json/json.hpp>
+
+namespace analyzeOutput {
+
+    inline nlohmann::json read(const std::filesystem::path& file) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in)
+            throw std::runtime_error("Could not open " + file.string());
+        std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(in)),
+                std::istreambuf_iterator<char>());
+        std::string ext = file.extension().string();
+        if (ext == ".cbor")
+            return nlohmann::json::from_cbor(data);
+        if (ext == ".msgpack")
+            return nlohmann::json::from_msgpack(data);
+        return nlohmann::json::parse(data);
+    }
+
+    // JSON is written the way analyze writes it, so converting a binary file
+    // back gives the file a JSON run would have produced
+    inline void write(const nlohmann::json& document, const std::filesystem::path& file) {
+        std::ofstream out(file, std::ios::binary);
+        if (!out)
+            throw std::runtime_error("Could not create " + file.string());
+        std::string ext = file.extension().string();
+        if (ext == ".cbor") {
+            nlohmann::json::to_cbor(document, nlohmann::detail::output_adapter<char>(out));
+        } else if (ext == ".msgpack") {
+            nlohmann::json::to_msgpack(document, nlohmann::detail::output_adapter<char>(out));
+        } else {
+            out << std::setw(4) << document << std::endl;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,452 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <chrono>
+
+#include "veri_file.h"
+#include "vhdl_file.h"
+#include "VeriModule.h"
+#include "VeriLibrary.h"
+#include "VhdlUnits.h"
+
+#include "content_hash.h"
+#include "parse_cache.h"
+
+namespace fs = std::filesystem;
+using namespace Verific ;
+
+// Bump whenever the key layout or the cache directory layout changes
+static const char* cacheFormat = "analyze-parse-cache-2";
+
+// ------------------------------
+// normalPath
+// ------------------------------
+static std::string normalPath(const fs::path& file) {
+    return fs::absolute(file).lexically_normal().string();
+}
+
+// ------------------------------
+// readFile
+// ------------------------------
+static bool readFile(const fs::path& file, std::string& content) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+        return false;
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    content = buffer.str();
+    return true;
+}
+
+// ------------------------------
+// hashVerilogSource
+// ------------------------------
+void parseCache::hashVerilogSource(const fs::path& file, const compileUnit& unit,
+        std::set<fs::path>& seen, bool& leaks, bool& macroInclude, contentHash& hash) {
+    std::string content;
+    hash.add(file.string());
+    if (!readFile(file, content)) {
+        hash.add("<missing>");
+        return;
+    }
+    hash.add(content);
+
+    // A unit defining macros changes the analysis of every unit after it
+    if (content.find("`define") != std::string::npos || content.find("`undef") != std::string::npos)
+        leaks = true;
+
+    // Included files are part of the unit, resolve them the way the
+    // preprocessor does: next to the including file, then the include dirs
+    size_t pos = 0;
+    while ((pos = content.find("`include", pos)) != std::string::npos) {
+        pos += 8;
+        while (pos < content.size() && (content[pos] == ' ' || content[pos] == '\t'))
+            pos++;
+        // `include `HDR_FILE: which file is read depends on the macro,
+        // which is not expanded here
+        if (pos < content.size() && content[pos] == '`') {
+            macroInclude = true;
+            continue;
+        }
+        if (pos >= content.size() || (content[pos] != '"' && content[pos] != '<'))
+            continue;
+        char close = content[pos] == '"' ? '"' : '>';
+        size_t end = content.find(close, pos + 1);
+        if (end == std::string::npos)
+            break;
+        std::string name = content.substr(pos + 1, end - pos - 1);
+        pos = end + 1;
+
+        std::vector<fs::path> candidates = {file.parent_path() / name, fs::path(name)};
+        for (auto& dir : unit.incdirs)
+            candidates.push_back(fs::path(dir) / name);
+
+        fs::path found;
+        for (auto& candidate : candidates) {
+            std::error_code ec;
+            if (fs::is_regular_file(candidate, ec)) {
+                found = candidate;
+                break;
+            }
+        }
+        if (found.empty()) {
+            hash.add("<unresolved>" + name);
+            continue;
+        }
+        if (seen.insert(fs::absolute(found).lexically_normal()).second)
+            hashVerilogSource(found, unit, seen, leaks, macroInclude, hash);
+    }
+}
+
+// ------------------------------
+// computeKey
+// ------------------------------
+std::string parseCache::computeKey(compileUnit& unit, const std::string& chain) {
+    contentHash hash;
+    hash.add(cacheFormat);
+    hash.add(chain);
+    hash.add(unit.isVhdl ? "vhdl" : "verilog");
+    hash.add(std::to_string(unit.mode));
+    hash.add(unit.work);
+
+    auto addList = [&hash](const char* tag, const std::vector<std::string>& list) {
+        hash.add(tag);
+        hash.add(std::to_string(list.size()));
+        for (auto& item : list)
+            hash.add(item);
+    };
+    addList("defines", unit.defines);
+    addList("macros", unit.macroOps);
+    addList("incdirs", unit.incdirs);
+    addList("libdirs", unit.libdirs);
+    addList("libexts", unit.libexts);
+    addList("lOptions", unit.lOptions);
+    hash.add(toolDigest);
+
+    unit.sources.clear();
+    unit.cacheable = true;
+    if (unit.isVhdl) {
+        hash.add("files");
+        for (auto& file : unit.files) {
+            hash.add(file);
+            hash.addFile(file);
+            unit.sources.insert(normalPath(file));
+        }
+        return hash.hex();
+    }
+
+    std::set<fs::path> seen;
+    bool leaks = false;
+    bool macroInclude = false;
+    hash.add("libfiles");
+    for (auto& file : unit.libfiles)
+        hashVerilogSource(file, unit, seen, leaks, macroInclude, hash);
+    hash.add("files");
+    for (auto& file : unit.files)
+        hashVerilogSource(file, unit, seen, leaks, macroInclude, hash);
+
+    // Modules resolved from the library directories are analyzed with the
+    // unit. Which files are read depends on the modules left undefined, so
+    // every file of the directories is part of the key.
+    hash.add("libdir files");
+    for (auto& libdir : unit.libdirs) {
+        std::vector<fs::path> files;
+        std::error_code ec;
+        for (fs::directory_iterator it(libdir, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec))
+                files.push_back(it->path());
+        }
+        std::sort(files.begin(), files.end());
+        hash.add(std::to_string(files.size()));
+        for (auto& file : files) {
+            if (seen.insert(fs::absolute(file).lexically_normal()).second)
+                hashVerilogSource(file, unit, seen, leaks, macroInclude, hash);
+        }
+    }
+    unit.leaksMacros = leaks;
+    unit.cacheable = !macroInclude;
+
+    for (auto& file : unit.libfiles)
+        unit.sources.insert(normalPath(file));
+    for (auto& file : unit.files)
+        unit.sources.insert(normalPath(file));
+    for (auto& file : seen)
+        unit.sources.insert(file.string());
+    return hash.hex();
+}
+
+// ------------------------------
+// plan
+// ------------------------------
+void parseCache::plan(std::vector<compileUnit>& units) {
+    // Trees saved by another build of analyze or Verific may not restore
+    // the same, or at all
+    contentHash tool;
+    tool.addFile("/proc/self/exe");
+    toolDigest = tool.hex();
+
+    // Units of one language are chained: a unit can only be restored
+    // when everything analyzed before it is unchanged as well
+    std::string veriChain;
+    std::string vhdlChain;
+    for (auto& unit : units) {
+        std::string& chain = unit.isVhdl ? vhdlChain : veriChain;
+        unit.key = computeKey(unit, chain);
+        chain = unit.key;
+    }
+
+    // The key of a unit including a file through a macro misses that
+    // file, which may also define macros for the units after it: none of
+    // the Verilog units from there on is cached
+    bool uncacheable = false;
+    for (auto& unit : units) {
+        if (unit.isVhdl)
+            continue;
+        if (!unit.cacheable && !uncacheable)
+            std::cout << "INFO: " << (unit.files.empty() ? std::string() : unit.files[0])
+                << " includes a file named by a macro, its compilation unit and the Verilog ones after it are not cached." << std::endl;
+        uncacheable = uncacheable || !unit.cacheable;
+        unit.cacheable = !uncacheable;
+    }
+
+    // Restoring a unit does not replay its `defines, so a unit leaking
+    // macros has to be analyzed again if any later Verilog unit is
+    bool laterAnalyzed = false;
+    for (auto it = units.rbegin(); it != units.rend(); ++it) {
+        std::error_code ec;
+        bool hit = fs::is_regular_file(dir / it->key / "manifest", ec);
+        if (it->isVhdl) {
+            it->restore = hit;
+            continue;
+        }
+        it->restore = it->cacheable && hit && !(laterAnalyzed && it->leaksMacros);
+        if (!it->restore)
+            laterAnalyzed = true;
+    }
+}
+
+// ------------------------------
+// restore
+// ------------------------------
+bool parseCache::restore(const compileUnit& unit) {
+    fs::path unitDir = dir / unit.key;
+    std::ifstream manifest(unitDir / "manifest");
+    if (!manifest)
+        return false;
+
+    if (unit.isVhdl)
+        vhdl_file::AddLibraryPath(unit.work.c_str(), unitDir.c_str());
+    else
+        veri_file::AddLibraryPath(unit.work.c_str(), unitDir.c_str());
+
+    std::string name;
+    while (std::getline(manifest, name)) {
+        if (name.empty())
+            continue;
+        bool ok = unit.isVhdl ?
+            vhdl_file::Restore(unit.work.c_str(), name.c_str(), 1) != nullptr :
+            veri_file::Restore(unit.work.c_str(), name.c_str(), 1) != nullptr;
+        if (!ok) {
+            std::cout << "WARNING: Could not restore " << name << " from parse cache, analyzing sources instead.\n";
+            return false;
+        }
+    }
+    // The time of the manifest tells prune() when the unit was last used
+    std::error_code ec;
+    fs::last_write_time(unitDir / "manifest", fs::file_time_type::clock::now(), ec);
+    restored++;
+    return true;
+}
+
+// ------------------------------
+// markLibrary
+// ------------------------------
+void parseCache::markLibrary(const compileUnit& unit) {
+    before.clear();
+    MapIter mi;
+    if (unit.isVhdl) {
+        VhdlLibrary* lib = vhdl_file::GetLibrary(unit.work.c_str());
+        VhdlPrimaryUnit* prim;
+        if (lib) FOREACH_VHDL_PRIMARY_UNIT(lib, mi, prim) {
+            before[prim->Name()] = prim;
+            MapIter si;
+            VhdlSecondaryUnit* sec;
+            FOREACH_VHDL_SECONDARY_UNIT(prim, si, sec) before[std::string(prim->Name()) + "." + sec->Name()] = sec;
+        }
+    } else {
+        VeriLibrary* lib = veri_file::GetLibrary(unit.work.c_str());
+        VeriModule* module;
+        if (lib) FOREACH_VERILOG_MODULE_IN_LIBRARY(lib, mi, module) before[module->Name()] = module;
+    }
+}
+
+// ------------------------------
+// newDesignUnits
+// ------------------------------
+// A design unit is new when its name was not in the library, when the
+// name now holds another unit, or when it was read from one of the files
+// of the unit. The last check catches a unit analyzed again into the
+// memory of the one it replaced, where the address alone looks unchanged.
+std::vector<std::string> parseCache::newDesignUnits(const compileUnit& unit) {
+    auto isNew = [this, &unit](const std::string& name, const void* designUnit, linefile_type linefile) {
+        auto it = before.find(name);
+        if (it == before.end() || it->second != designUnit)
+            return true;
+        const char* file = LineFile::GetFileName(linefile);
+        return file && unit.sources.count(normalPath(file)) != 0;
+    };
+
+    std::vector<std::string> names;
+    MapIter mi;
+    if (unit.isVhdl) {
+        VhdlLibrary* lib = vhdl_file::GetLibrary(unit.work.c_str());
+        VhdlPrimaryUnit* prim;
+        if (lib) FOREACH_VHDL_PRIMARY_UNIT(lib, mi, prim) {
+            // An architecture analyzed on its own still has to be saved
+            // through its entity
+            bool added = isNew(prim->Name(), prim, prim->Linefile());
+            MapIter si;
+            VhdlSecondaryUnit* sec;
+            FOREACH_VHDL_SECONDARY_UNIT(prim, si, sec) {
+                if (isNew(std::string(prim->Name()) + "." + sec->Name(), sec, sec->Linefile()))
+                    added = true;
+            }
+            if (added)
+                names.push_back(prim->Name());
+        }
+    } else {
+        VeriLibrary* lib = veri_file::GetLibrary(unit.work.c_str());
+        VeriModule* module;
+        if (lib) FOREACH_VERILOG_MODULE_IN_LIBRARY(lib, mi, module) {
+            if (isNew(module->Name(), module, module->Linefile()))
+                names.push_back(module->Name());
+        }
+    }
+    return names;
+}
+
+// ------------------------------
+// save
+// ------------------------------
+void parseCache::save(const compileUnit& unit) {
+    if (saveFailed || !unit.cacheable)
+        return;
+
+    // Written next to its final location and renamed, so that a concurrent
+    // or interrupted run never sees a partial unit
+    fs::path unitDir = dir / unit.key;
+    std::random_device rd;
+    fs::path tmpDir = dir / (unit.key + ".tmp" + std::to_string(rd()));
+    std::error_code ec;
+    fs::create_directories(tmpDir, ec);
+    if (ec) {
+        std::cout << "WARNING: Could not create parse cache directory " << tmpDir << ": " << ec.message() << std::endl;
+        saveFailed = true;
+        return;
+    }
+
+    if (unit.isVhdl)
+        vhdl_file::AddLibraryPath(unit.work.c_str(), tmpDir.c_str());
+    else
+        veri_file::AddLibraryPath(unit.work.c_str(), tmpDir.c_str());
+
+    std::ofstream manifest(tmpDir / "manifest");
+    for (auto& name : newDesignUnits(unit)) {
+        bool ok = unit.isVhdl ?
+            vhdl_file::Save(unit.work.c_str(), name.c_str()) :
+            veri_file::Save(unit.work.c_str(), name.c_str());
+        if (!ok) {
+            std::cout << "WARNING: Could not save " << name << " to parse cache, caching disabled for this run.\n";
+            saveFailed = true;
+            manifest.close();
+            fs::remove_all(tmpDir, ec);
+            return;
+        }
+        manifest << name << "\n";
+    }
+    manifest.close();
+
+    fs::remove_all(unitDir, ec);
+    fs::rename(tmpDir, unitDir, ec);
+    if (ec) {
+        fs::remove_all(tmpDir, ec);
+        return;
+    }
+
+    if (unit.isVhdl)
+        vhdl_file::AddLibraryPath(unit.work.c_str(), unitDir.c_str());
+    else
+        veri_file::AddLibraryPath(unit.work.c_str(), unitDir.c_str());
+}
+
+// ------------------------------
+// prune
+// ------------------------------
+// Units are ordered by the time of their manifest, which is written when
+// the unit is saved and touched when it is restored. Directories without
+// a manifest are units being saved by another run, or left by a run that
+// was interrupted: they are only removed once they are an hour old.
+void parseCache::prune(const std::vector<compileUnit>& units) {
+    if (!limit)
+        return;
+    std::set<std::string> used;
+    for (auto& unit : units)
+        used.insert(unit.key);
+
+    struct entry {
+        fs::file_time_type time;
+        uintmax_t size;
+        fs::path path;
+    };
+    std::vector<entry> entries;
+    uintmax_t total = 0;
+    auto now = fs::file_time_type::clock::now();
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code fileEc;
+        if (!it->is_directory(fileEc))
+            continue;
+        entry unitEntry = {fs::file_time_type(), 0, it->path()};
+        for (fs::recursive_directory_iterator file(it->path(), fileEc), fileEnd; !fileEc && file != fileEnd;
+                file.increment(fileEc)) {
+            std::error_code sizeEc;
+            if (file->is_regular_file(sizeEc))
+                unitEntry.size += file->file_size(sizeEc);
+        }
+        total += unitEntry.size;
+        if (used.count(it->path().filename().string()))
+            continue;
+        unitEntry.time = fs::last_write_time(it->path() / "manifest", fileEc);
+        if (fileEc) {
+            fs::file_time_type created = fs::last_write_time(it->path(), fileEc);
+            if (fileEc || now - created < std::chrono::hours(1))
+                continue;
+            unitEntry.time = created;
+        }
+        entries.push_back(unitEntry);
+    }
+    if (total <= limit)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const entry& a, const entry& b) { return a.time < b.time; });
+    size_t removed = 0;
+    for (auto& unitEntry : entries) {
+        if (total <= limit)
+            break;
+        fs::remove_all(unitEntry.path, ec);
+        if (ec)
+            continue;
+        total -= unitEntry.size;
+        removed++;
+    }
+    std::cout << "INFO: Removed " << removed << " least recently used compilation units from parse cache "
+        << dir << "." << std::endl;
+}
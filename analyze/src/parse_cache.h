@@ -0,0 +1,90 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#ifndef PARSE_CACHE_H
+#define PARSE_CACHE_H
+
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <set>
+#include <map>
+#include <filesystem>
+
+class contentHash;
+
+// One analysis call described by the instruction file: a Verilog file set
+// analyzed as a single compilation unit, or a VHDL file list analyzed file
+// by file. The option vectors are a snapshot of the state accumulated so
+// far, since that is what Verific sees when the unit is analyzed.
+struct compileUnit {
+    bool isVhdl = false;
+    unsigned mode = 0;
+    std::string work = "work";
+    std::vector<std::string> files;
+    std::vector<std::string> defines;   // -D<macro>[=<value>] of this line
+    std::vector<std::string> macroOps;  // -vlog-define/-vlog-undef seen so far
+    std::vector<std::string> incdirs;
+    std::vector<std::string> libdirs;
+    std::vector<std::string> libexts;
+    std::vector<std::string> libfiles;
+    std::vector<std::string> lOptions;
+
+    // Filled by parseCache::plan
+    std::string key;
+    std::set<std::string> sources;      // normalized paths of every file the unit reads
+    bool leaksMacros = false;
+    bool cacheable = true;              // false when the key cannot cover every file the unit reads
+    bool restore = false;
+};
+
+// On-disk cache of analyzed parse trees, one directory per compilation unit
+// named by the hash of everything that can influence its analysis. The
+// least recently used units are removed once the directory outgrows its
+// size limit.
+class parseCache {
+    public:
+        // limitMB: size limit of the directory, 0 for none
+        parseCache(const std::filesystem::path& dir, size_t limitMB = defaultLimitMB) :
+            dir(dir), limit((uintmax_t)limitMB << 20) {}
+
+        static const size_t defaultLimitMB = 2048;
+
+        // Computes the unit keys and decides which units can be restored
+        void plan(std::vector<compileUnit>& units);
+
+        bool restore(const compileUnit& unit);
+
+        // Remembers the library contents, so that save() only stores what
+        // the analysis of the unit has added or replaced
+        void markLibrary(const compileUnit& unit);
+
+        void save(const compileUnit& unit);
+
+        // Removes the least recently used units until the directory is
+        // within its size limit, the units of this run are kept
+        void prune(const std::vector<compileUnit>& units);
+
+        size_t restoredCount() const { return restored; }
+
+    private:
+        std::string computeKey(compileUnit& unit, const std::string& chain);
+
+        void hashVerilogSource(const std::filesystem::path& file, const compileUnit& unit,
+                std::set<std::filesystem::path>& seen, bool& leaks, bool& macroInclude, contentHash& hash);
+
+        std::vector<std::string> newDesignUnits(const compileUnit& unit);
+
+        std::filesystem::path dir;
+        uintmax_t limit;            // in bytes, 0 for none
+        std::string toolDigest;     // of the analyze executable, Verific included
+        // Design units in the library before the analysis of a unit, by name
+        std::map<std::string, const void*> before;
+        size_t restored = 0;
+        bool saveFailed = false;
+};
+
+#endif
@@ -4,9 +4,11 @@
 //
 // ---------------------------------------------------------------
 
+#include <climits>
+
 #include "port_dump.h"
 
-void portDump::saveVeriInfo(Array *verilogModules, json& portInfo) {
+void portDump::saveVeriInfo(Array *verilogModules, jsonSpool& portInfo) {
     int p;
     VeriModule* veriMod;
     FOREACH_ARRAY_ITEM(verilogModules, p, veriMod) {
@@ -17,7 +19,7 @@ void portDump::saveVeriInfo(Array *verilogModules, json& portInfo) {
         json module;
         module["topModule"] = veriMod->Name();
         saveVeriModulePortsInfo(veriMod, module);
-        portInfo.push_back(module);
+        portInfo.append(module);
     }
 }
 
@@ -29,8 +31,17 @@ void portDump::saveVeriModulePortsInfo(VeriModule* veriMod, json& module) {
         if (!port)
             continue;
         json range;
-        range["msb"] = port->LeftRangeBound();
-        range["lsb"] = port->RightRangeBound();
+        if (elaborated) {
+            range["msb"] = port->LeftRangeBound();
+            range["lsb"] = port->RightRangeBound();
+        } else {
+            int msb = 0;
+            int lsb = 0;
+            VeriDataType *dataType = port->GetDataType();
+            parseVeriRange(dataType ? dataType->GetDimensions() : nullptr, msb, lsb);
+            range["msb"] = msb;
+            range["lsb"] = lsb;
+        }
         std::string type = types.find(port->Type()) != types.end() ? types[port->Type()] : "Unknown";
         module["ports"].push_back({{"name", port->GetName()}, 
                 {"direction", directions[port->Dir()]}, 
@@ -148,7 +159,143 @@ void portDump::parseVhdlRange(VhdlDiscreteRange *pDiscreteRange, int& msb, int&
     }
 }
 
-void portDump::saveVhdlInfo(Array *vhdlModules, json& portInfo) {
+// ------------------------------
+// integerPower
+// ------------------------------
+// Verilog integer power, false when the result does not fit
+static bool integerPower(long base, long exp, long& res) {
+    res = 1;
+    if (exp < 0) {
+        // 1 ** -n is 1, (-1) ** -n is +-1, 0 ** -n is x and anything else 0
+        res = base == 1 ? 1 : base == -1 ? (exp % 2 ? -1 : 1) : 0;
+        return base != 0;
+    }
+    for (; exp > 0; exp >>= 1) {
+        if ((exp & 1) && __builtin_mul_overflow(res, base, &res))
+            return false;
+        if (exp > 1 && __builtin_mul_overflow(base, base, &base))
+            return false;
+    }
+    return true;
+}
+
+long portDump::parseVeriExpression(VeriExpression *expr) {
+    if (!expr)
+        return 0;
+    switch (expr->GetClassId()) {
+        case ID_VERICONSTVAL:
+            {
+                return static_cast<VeriConstVal*>(expr)->Integer();
+            }
+        case ID_VERIINTVAL:
+            {
+                return static_cast<VeriIntVal*>(expr)->GetNum();
+            }
+        case ID_VERIIDREF:
+            {
+                VeriIdDef *id = expr->FullId();
+                if (!id || !id->IsParam()) {
+                    std::cout << "Unknown identifier: " << (id ? id->Name() : "") << std::endl;
+                    return 0;
+                }
+                return parseVeriExpression(id->GetInitialValue());
+            }
+        case ID_VERIBINARYOPERATOR:
+            {
+                VeriBinaryOperator *pOperator = static_cast<VeriBinaryOperator*>(expr);
+                unsigned op = pOperator->OperType();
+                long l = parseVeriExpression(pOperator->GetLeft());
+                long r = parseVeriExpression(pOperator->GetRight());
+                long res = 0;
+                bool exact = true;
+                switch (op) {
+                    case VERI_PLUS:
+                        exact = !__builtin_add_overflow(l, r, &res);
+                        break;
+                    case VERI_MIN:
+                        exact = !__builtin_sub_overflow(l, r, &res);
+                        break;
+                    case VERI_MUL:
+                        exact = !__builtin_mul_overflow(l, r, &res);
+                        break;
+                    case VERI_DIV:
+                        exact = !(l == LONG_MIN && r == -1);
+                        res = r && exact ? l / r : 0;
+                        break;
+                    case VERI_MODULUS:
+                        exact = !(l == LONG_MIN && r == -1);
+                        res = r && exact ? l % r : 0;
+                        break;
+                    case VERI_POWER:
+                        exact = integerPower(l, r, res);
+                        break;
+                    case VERI_LSHIFT:
+                        exact = l >= 0 && r >= 0 && r < 63 && l <= (LONG_MAX >> r);
+                        res = exact ? l << r : 0;
+                        break;
+                    case VERI_RSHIFT:
+                        exact = r >= 0 && r < 64;
+                        res = exact ? l >> r : 0;
+                        break;
+                    default:
+                        std::cout << "Unknown operation: " << op << std::endl;
+                        return 0;
+                }
+                if (!exact) {
+                    std::cout << "Value out of range: " << l << " " << op << " " << r << std::endl;
+                    return 0;
+                }
+                return res;
+            }
+        case ID_VERIUNARYOPERATOR:
+            {
+                VeriUnaryOperator *pOperator = static_cast<VeriUnaryOperator*>(expr);
+                long arg = parseVeriExpression(pOperator->GetArg());
+                switch (pOperator->OperType()) {
+                    case VERI_MIN:
+                        return arg == LONG_MIN ? 0 : -arg;
+                    case VERI_PLUS:
+                        return arg;
+                    default:
+                        std::cout << "Unknown operation: " << pOperator->OperType() << std::endl;
+                        return 0;
+                }
+            }
+        case ID_VERIQUESTIONCOLON:
+            {
+                VeriQuestionColon *pCond = static_cast<VeriQuestionColon*>(expr);
+                return parseVeriExpression(pCond->GetIfExpr()) ?
+                    parseVeriExpression(pCond->GetThenExpr()) : parseVeriExpression(pCond->GetElseExpr());
+            }
+        case ID_VERISYSTEMFUNCTIONCALL:
+            {
+                VeriSystemFunctionCall *pCall = static_cast<VeriSystemFunctionCall*>(expr);
+                if (pCall->GetFunctionType() == VERI_SYS_CALL_CLOG2 && pCall->GetArgs() && pCall->GetArgs()->Size() == 1) {
+                    long arg = parseVeriExpression(static_cast<VeriExpression*>(pCall->GetArgs()->At(0)));
+                    long res = 0;
+                    while (res < 63 && (1L << res) < arg)
+                        res++;
+                    return res;
+                }
+                std::cout << "Unknown system function: " << pCall->GetFunctionType() << std::endl;
+                return 0;
+            }
+        default:
+            {
+                std::cout << "Unknown type: " << expr->GetClassId() << std::endl;
+                return 0;
+            }
+    }
+}
+
+void portDump::parseVeriRange(VeriRange *range, int& msb, int& lsb) {
+    if (!range)
+        return;
+    msb = parseVeriExpression(range->GetLeft());
+    lsb = parseVeriExpression(range->GetRight());
+}
+
+void portDump::saveVhdlInfo(Array *vhdlModules, jsonSpool& portInfo) {
     int k;
     VhdlPrimaryUnit* mod;
     FOREACH_ARRAY_ITEM(vhdlModules, k, mod) {
@@ -157,7 +304,7 @@ void portDump::saveVhdlInfo(Array *vhdlModules, json& portInfo) {
         json module;
         module["topModule"] = mod->Name();
         saveVhdlModulePortsInfo(mod, module);
-        portInfo.push_back(module);
+        portInfo.append(module);
     }
 }
 
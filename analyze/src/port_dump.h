@@ -18,12 +18,16 @@
 
 #include <nlohmann_json/json.hpp>
 
+#include "json_writer.h"
+
 #include "veri_file.h"
 #include "vhdl_file.h"
 #include "VeriModule.h"
 #include "VhdlUnits.h"
 #include "VhdlIdDef.h"
 #include "VeriId.h"
+#include "VeriConstVal.h"
+#include "VeriExpression.h"
 #include "file_sort_veri_tokens.h"
 #include "hier_tree.h"
 #include "Netlist.h"
@@ -77,17 +81,24 @@ class portDump {
 
     portDump(std::string fileName): file(fileName) {}
 
-    virtual void saveVeriInfo(Array *verilogModules, json& portInfo);
+    virtual void saveVeriInfo(Array *verilogModules, jsonSpool& portInfo);
 
     void saveVeriModulePortsInfo(VeriModule* veriMod, json& module);
 
+    long parseVeriExpression(VeriExpression *expr);
+
+    void parseVeriRange(VeriRange *range, int& msb, int& lsb);
+
+    // Without elaboration Verilog port ranges are evaluated from the parse tree
+    void setElaborated(bool value) { elaborated = value; }
+
     long parseVhdlExpression(VhdlExpression *expr);
 
     std::string parseVhdlExpressionStr(VhdlExpression *expr);
 
     void parseVhdlRange(VhdlDiscreteRange *pDiscreteRange, int& msb, int& lsb);
 
-    virtual void saveVhdlInfo(Array *vhdlModules, json& portInfo);
+    virtual void saveVhdlInfo(Array *vhdlModules, jsonSpool& portInfo);
 
     void saveVhdlModulePortsInfo(VhdlPrimaryUnit* mod, json& module);
 
@@ -96,13 +107,49 @@ class portDump {
         saveVeriInfo(verilogModules, portInfo);
     }
 
+    // Port record of a top module collected by another traversal
+    void savePortRecord(const json& module) {
+        portInfo.append(module);
+    }
+
+    // Binary formats replace the extension of the output file
+    virtual void setFormat(outputFormat value) {
+        format = value;
+        portInfo.setFormat(value);
+        file = std::filesystem::path(file).replace_extension(outputExtension(format)).string();
+    }
+
+    // Records are serialized by the pool while the design is traversed
+    virtual void setThreadPool(threadPool* pool) {
+        portInfo.setThreadPool(pool);
+    }
+
     void saveJson() {
-        std::ofstream o(file);
-        o << std::setw(4) << portInfo << std::endl;
+        std::ofstream o(file, std::ios::binary);
+        jsonWriter writer(o, format);
+        writer.beginArray(portInfo.size());
+        writer.elements(portInfo);
+        writer.endArray();
+        if (format == outputFormat::json || format == outputFormat::compactJson)
+            o << std::endl;
+    }
+
+    // Records dumped by a worker process, one JSON value per line, to be
+    // merged by the main process
+    void savePartial(std::ostream& out) {
+        portInfo.forEach([&out](const std::string&, const json& record) {
+                out << json({{"port", record}}).dump() << '\n';
+                });
+    }
+
+    void mergePartial(const json& line) {
+        portInfo.append(line["port"]);
     }
 
     protected:
-    json portInfo = json::array();
+    jsonSpool portInfo{1};
     std::string file;
+    outputFormat format = outputFormat::json;
+    bool elaborated = true;
 };
 #endif
@@ -0,0 +1,105 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#include <fstream>
+#include <iomanip>
+#include <ctime>
+#include <algorithm>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <nlohmann_json/json.hpp>
+
+#include "profiler.h"
+
+using json = nlohmann::json;
+
+profiler::profiler() {
+    start = std::chrono::steady_clock::now();
+    cpuStart = cpuSeconds();
+}
+
+double profiler::cpuSeconds() {
+#ifndef _WIN32
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+        (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#else
+    return (double)std::clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+long profiler::peakRssKb() {
+#ifndef _WIN32
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+profiler::phase::phase(profiler& prof, const std::string& name, const std::string& library):
+    prof(prof), name(name), library(library) {
+    wallStart = std::chrono::steady_clock::now();
+    cpuStart = cpuSeconds();
+    rssStart = peakRssKb();
+}
+
+profiler::phase::~phase() {
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+    prof.add(name, library, wall.count(), cpuSeconds() - cpuStart, rssStart, peakRssKb());
+}
+
+void profiler::add(const std::string& name, const std::string& library, double wall, double cpu,
+        long rssStart, long rssEnd) {
+    record* rec = nullptr;
+    for (auto& r : records) {
+        if (r.name == name && r.library == library) {
+            rec = &r;
+            break;
+        }
+    }
+    if (!rec) {
+        records.push_back({name, library});
+        rec = &records.back();
+    }
+    rec->calls++;
+    rec->wall += wall;
+    rec->cpu += cpu;
+    rec->peakRss = std::max(rec->peakRss, rssEnd);
+    rec->rssGrowth += rssEnd - rssStart;
+}
+
+void profiler::save(const std::filesystem::path& file) const {
+    json phases = json::array();
+    for (auto& r : records) {
+        json phase;
+        phase["phase"] = r.name;
+        if (!r.library.empty())
+            phase["library"] = r.library;
+        phase["calls"] = r.calls;
+        phase["wallSeconds"] = r.wall;
+        phase["cpuSeconds"] = r.cpu;
+        phase["peakRssKb"] = r.peakRss;
+        phase["peakRssGrowthKb"] = r.rssGrowth;
+        phases.push_back(phase);
+    }
+
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    json result;
+    result["phases"] = phases;
+    result["total"] = {{"wallSeconds", wall.count()}, {"cpuSeconds", cpuSeconds() - cpuStart},
+        {"peakRssKb", peakRssKb()}};
+    std::ofstream o(file);
+    o << std::setw(4) << result << std::endl;
+}
@@ -0,0 +1,66 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+
+// Wall time, CPU time and peak resident memory of the phases of a run.
+// Phases with the same name and work library are accumulated.
+class profiler {
+    public:
+        // Measures from construction to destruction
+        class phase {
+            public:
+                phase(profiler& prof, const std::string& name, const std::string& library = "");
+
+                ~phase();
+
+                phase(const phase&) = delete;
+
+                phase& operator=(const phase&) = delete;
+
+            private:
+                profiler& prof;
+                std::string name;
+                std::string library;
+                std::chrono::steady_clock::time_point wallStart;
+                double cpuStart;
+                long rssStart;
+        };
+
+        profiler();
+
+        void save(const std::filesystem::path& file) const;
+
+    private:
+        struct record {
+            std::string name;
+            std::string library;
+            unsigned calls = 0;
+            double wall = 0;
+            double cpu = 0;
+            long peakRss = 0;       // high water mark at the end of the phase, kB
+            long rssGrowth = 0;     // increase of the high water mark, kB
+        };
+
+        void add(const std::string& name, const std::string& library, double wall, double cpu,
+                long rssStart, long rssEnd);
+
+        static double cpuSeconds();
+
+        static long peakRssKb();
+
+        std::chrono::steady_clock::time_point start;
+        double cpuStart;
+        std::vector<record> records;
+};
+
+#endif
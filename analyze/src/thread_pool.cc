@@ -0,0 +1,37 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#include "thread_pool.h"
+
+threadPool::threadPool(unsigned count) {
+    for (unsigned i = 0; i < count; i++)
+        threads.emplace_back([this]() { work(); });
+}
+
+threadPool::~threadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void threadPool::work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
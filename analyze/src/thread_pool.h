@@ -0,0 +1,55 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+// Fixed set of threads picking submitted tasks in submission order.
+class threadPool {
+    public:
+        threadPool(unsigned threads);
+
+        // Waits for the queued tasks
+        ~threadPool();
+
+        threadPool(const threadPool&) = delete;
+
+        threadPool& operator=(const threadPool&) = delete;
+
+        template<typename F>
+        auto submit(F task) -> std::future<decltype(task())> {
+            auto packaged = std::make_shared<std::packaged_task<decltype(task())()>>(std::move(task));
+            std::future<decltype(task())> res = packaged->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push([packaged]() { (*packaged)(); });
+            }
+            wakeUp.notify_one();
+            return res;
+        }
+
+        unsigned size() const { return threads.size(); }
+
+    private:
+        void work();
+
+        std::vector<std::thread> threads;
+        std::queue<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable wakeUp;
+        bool stopping = false;
+};
+
+#endif
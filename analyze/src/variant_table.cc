@@ -0,0 +1,37 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#include "variant_table.h"
+
+size_t variantTable::tupleHash::operator()(const tuple& key) const {
+    size_t h = key.size();
+    for (uint32_t id : key)
+        h ^= id + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+}
+
+uint32_t variantTable::intern(const std::string& name) {
+    auto res = nameIds.emplace(name, names.size());
+    if (res.second)
+        names.push_back(&res.first->first);
+    return res.first->second;
+}
+
+unsigned variantTable::variant(const tuple& key, bool& added) {
+    auto res = ids.emplace(key, texts.size());
+    added = res.second;
+    if (added) {
+        std::string text = key.empty() ? "" : *names[key[0]];
+        for (size_t i = 1; i + 1 < key.size(); i += 2) {
+            text.append("_");
+            text.append(*names[key[i]]);
+            text.append("#");
+            text.append(*names[key[i + 1]]);
+        }
+        texts.push_back(text);
+    }
+    return res.first->second;
+}
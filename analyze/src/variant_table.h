@@ -0,0 +1,43 @@
+// ---------------------------------------------------------------
+// Copyright : RapidSilicon (10.2026)
+//
+//
+// ---------------------------------------------------------------
+
+#ifndef VARIANT_TABLE_H
+#define VARIANT_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Interned identifiers of module variants. A variant is the tuple of the
+// instantiated module name followed by parameter name/value pairs, all
+// interned to numbers, so looking a variant up hashes a few integers. The
+// textual key ("module_param#value...") is only built for new variants.
+class variantTable {
+    public:
+        typedef std::vector<uint32_t> tuple;
+
+        uint32_t intern(const std::string& name);
+
+        // Returns the variant ID, added tells whether it is a new variant
+        unsigned variant(const tuple& key, bool& added);
+
+        const std::string& text(unsigned id) const { return texts[id]; }
+
+        size_t size() const { return texts.size(); }
+
+    private:
+        struct tupleHash {
+            size_t operator()(const tuple& key) const;
+        };
+
+        std::unordered_map<std::string, uint32_t> nameIds;
+        std::vector<const std::string*> names;
+        std::unordered_map<tuple, unsigned, tupleHash> ids;
+        std::vector<std::string> texts;
+};
+
+#endif
@@ -0,0 +1,5 @@
+-vlog-incdir .
+-sv rtl/hier_leaf.sv
+-sv rtl/hier_mid.sv
+-sv rtl/hier_top.sv
+-top hier_top
@@ -0,0 +1,26 @@
+// Register stage of W bits, or of BYTES bytes when BYTES is set, so that
+// different parameter sets can elaborate to the same stage.
+
+module hier_leaf #(
+  parameter W = 1,
+  parameter BYTES = 0
+) (
+  input                                clk_i,
+  input  [(BYTES ? BYTES * 8 : W)-1:0] d_i,
+  output [(BYTES ? BYTES * 8 : W)-1:0] q_o
+);
+
+  logic [(BYTES ? BYTES * 8 : W)-1:0] q;
+  logic [(BYTES ? BYTES * 8 : W)-1:0] _q_next;
+  logic                               dbg_valid;
+
+  assign _q_next = d_i;
+  assign dbg_valid = 1'b1;
+
+  always_ff @(posedge clk_i) begin
+    q <= _q_next;
+  end
+
+  assign q_o = q;
+
+endmodule
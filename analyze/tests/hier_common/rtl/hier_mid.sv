@@ -0,0 +1,18 @@
+// Two 8-bit register stages, the second one sized in bytes
+
+module hier_mid (
+  input        clk_i,
+  input  [7:0] d_i,
+  output [7:0] q_o
+);
+
+  logic [7:0] stage;
+  logic       dbg_mid;
+
+  hier_leaf #(.W(8), .BYTES(0)) u_first (.clk_i(clk_i), .d_i(d_i), .q_o(stage));
+
+  hier_leaf #(.W(4), .BYTES(1)) u_second (.clk_i(clk_i), .d_i(stage), .q_o(q_o));
+
+  assign dbg_mid = stage[0];
+
+endmodule
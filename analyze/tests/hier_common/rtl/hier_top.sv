@@ -0,0 +1,16 @@
+// Shared by the hierarchy option tests: two pipelines below the top, one
+// of them through hier_mid
+
+module hier_top (
+  input        clk_i,
+  input  [7:0] a_i,
+  input  [3:0] b_i,
+  output [7:0] a_o,
+  output [3:0] b_o
+);
+
+  hier_mid u_mid (.clk_i(clk_i), .d_i(a_i), .q_o(a_o));
+
+  hier_leaf #(.W(4), .BYTES(0)) u_leaf (.clk_i(clk_i), .d_i(b_i), .q_o(b_o));
+
+endmodule
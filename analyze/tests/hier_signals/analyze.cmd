@@ -0,0 +1,7 @@
+-vlog-incdir .
+-sv ../hier_common/rtl/hier_leaf.sv
+-sv ../hier_common/rtl/hier_mid.sv
+-sv ../hier_common/rtl/hier_top.sv
+-top hier_top
+-signals-exclude ^dbg_
+-signals-skip-generated
@@ -0,0 +1,7 @@
+-vlog-incdir .
+-set-warning VHDL-1242
+-vhdl2008 rtl/Key_Sequence_Module.vhd
+-vhdl2008 rtl/Trivium_Module.vhd
+-sv rtl/mixed_top.sv
+-top mixed_top
+-hier-index
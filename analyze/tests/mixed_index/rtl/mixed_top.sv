@@ -0,0 +1,21 @@
+// Verilog top above a VHDL hierarchy: the index must reach the instance
+// of the VHDL entity below it
+module mixed_top (
+    input  logic        clk_i,
+    input  logic        init_i,
+    input  logic [79:0] key_i,
+    input  logic [79:0] iv_i,
+    input  logic        text_i,
+    output logic        cipher_o
+);
+
+    Trivium_Module u_trivium (
+        .cipher_text(cipher_o),
+        .clock(clk_i),
+        .init(init_i),
+        .K(key_i),
+        .IV(iv_i),
+        .open_text(text_i)
+    );
+
+endmodule
@@ -0,0 +1,4 @@
+-vlog-incdir .
+-sv rtl/fold_leaf.sv
+-sv rtl/param_fold.sv
+-top param_fold
@@ -0,0 +1,20 @@
+// Register stage instantiated with folded parameter values
+
+module fold_leaf #(
+  parameter W = 1,
+  parameter D = 0
+) (
+  input          clk_i,
+  input  [W-1:0] d_i,
+  output [W-1:0] q_o
+);
+
+  logic [W-1:0] q;
+
+  always_ff @(posedge clk_i) begin
+    q <= d_i;
+  end
+
+  assign q_o = q;
+
+endmodule
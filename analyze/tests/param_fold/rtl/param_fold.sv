@@ -0,0 +1,27 @@
+// Instance parameters given as constant expressions. Integer arithmetic over
+// integer literals and integer parameters is folded to its value, anything
+// whose value is not exactly a 32-bit signed integer stays "Unknown".
+
+module param_fold #(
+  parameter N = 4
+) (
+  input        clk_i,
+  input  [7:0] d_i,
+  output [7:0] q_mul_o,
+  output [7:0] q_shift_o,
+  output [7:0] q_cond_o,
+  output [7:0] q_ovf_o,
+  output [7:0] q_sized_o
+);
+
+  fold_leaf #(.W(N * 2), .D(N - 5)) u_mul (.clk_i(clk_i), .d_i(d_i), .q_o(q_mul_o));
+
+  fold_leaf #(.W(8), .D(N << 2 >> 1)) u_shift (.clk_i(clk_i), .d_i(d_i), .q_o(q_shift_o));
+
+  fold_leaf #(.W(N + N), .D(N ? 10 % N : -N)) u_cond (.clk_i(clk_i), .d_i(d_i), .q_o(q_cond_o));
+
+  fold_leaf #(.W(8), .D(2147483647 + N)) u_ovf (.clk_i(clk_i), .d_i(d_i), .q_o(q_ovf_o));
+
+  fold_leaf #(.W(8), .D(4'd3 + N)) u_sized (.clk_i(clk_i), .d_i(d_i), .q_o(q_sized_o));
+
+endmodule
@@ -0,0 +1,78 @@
+/* IO primitives linked through chains of assignments (WIRE instances in the
+   IO config) and a fabric clock through FCLK_BUF */
+
+module I_BUF_to_WIRE_to_O_BUF(clk_i_buf, data_i, data_o, fclk_q_o);
+  input clk_i_buf;
+  input data_i;
+  output data_o;
+  output fclk_q_o;
+  wire clk_i;
+  wire clk_buf_i;
+  wire data_i_buf;
+  wire data_w0;
+  wire data_w1;
+  wire data_dly;
+  wire q;
+  wire q_w0;
+  wire q_w1;
+  wire fclk;
+  wire fclk_q;
+  wire fclk_q_w0;
+  I_BUF #(
+    .WEAK_KEEPER("PULLDOWN")
+  ) clk_ibuf (
+    .EN(1'h1),
+    .I(clk_i_buf),
+    .O(clk_i)
+  );
+  CLK_BUF clock_buffer (
+    .I(clk_i),
+    .O(clk_buf_i)
+  );
+  I_BUF data_ibuf (
+    .EN(1'h1),
+    .I(data_i),
+    .O(data_i_buf)
+  );
+  assign data_w0 = data_i_buf;
+  assign data_w1 = data_w0;
+  I_DELAY #(
+    .DELAY(32'h00000000)
+  ) data_i_delay (
+    .CLK_IN(clk_buf_i),
+    .DLY_ADJ(1'h0),
+    .DLY_INCDEC(1'h0),
+    .DLY_LOAD(1'h0),
+    .I(data_w1),
+    .O(data_dly)
+  );
+  DFFRE q_reg (
+    .C(clk_buf_i),
+    .D(data_dly),
+    .E(1'h1),
+    .Q(q),
+    .R(1'h1)
+  );
+  assign q_w0 = q;
+  assign q_w1 = q_w0;
+  O_BUF data_obuf (
+    .I(q_w1),
+    .O(data_o)
+  );
+  FCLK_BUF fclk_buf (
+    .I(q),
+    .O(fclk)
+  );
+  DFFRE fclk_reg (
+    .C(fclk),
+    .D(data_dly),
+    .E(1'h1),
+    .Q(fclk_q),
+    .R(1'h1)
+  );
+  assign fclk_q_w0 = fclk_q;
+  O_BUF fclk_obuf (
+    .I(fclk_q_w0),
+    .O(fclk_q_o)
+  );
+endmodule
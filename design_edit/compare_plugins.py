@@ -0,0 +1,242 @@
+"""Runs two builds of the design-edit plugin on the same designs and
+compares their io_config.json and design_edit.sdc.
+
+The designs are the cases of Tests/ and --random generated ones. A
+generated design has I_BUF inputs, some through an I_DELAY, registers
+clocked by CLK_BUF or FCLK_BUF clocks, and O_BUF outputs. Inputs and
+outputs are reached through chains of assignments, which become WIRE
+instances of the IO config. Pin locations are drawn at random too.
+
+To check a change against the plugin before it:
+
+    git worktree add /tmp/de_before <commit before the change>
+    make -C /tmp/de_before/design_edit
+    make
+    python3 compare_plugins.py --before /tmp/de_before/design_edit/design-edit.so \\
+        --after ./design-edit.so --random 200
+
+Designs that give different outputs are kept under --work-dir with the
+outputs of both plugins. The exit status is 1 if any design differs.
+"""
+import argparse
+import difflib
+import glob
+import os
+import random
+import re
+import shutil
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+CELL_MODELS = "yosys-rs-plugin/genesis3/FPGA_PRIMITIVES_MODELS/blackbox_models/cell_sim_blackbox.v"
+
+# Outputs compared, relative to the design directory
+OUTPUTS = ["tmp/io_config.json", "design_edit.sdc"]
+
+# HP_1_<2k>_<k>P and HP_1_<2k+1>_<k>N, as in the pin files of Tests/
+DATA_PINS = ["HP_1_%d_%d%s" % (i, i // 2, "N" if i % 2 else "P") for i in range(18)]
+CLOCK_PINS = ["HP_1_CC_18_9P"]
+
+SCRIPT = """read_verilog -sv {models}
+read_verilog ./rtl/{name}.v
+hierarchy -auto-top
+plugin -i {plugin}
+design_edit -tech genesis3 -sdc pin_constraints.pin -json ./tmp/io_config.json -w ./tmp/wrapper_{name}.v ./tmp/wrapper_{name}.eblif
+"""
+
+
+def generate(name, rng):
+    """Returns the Verilog of a random design and its pin constraints."""
+    lines = []
+    wires = []
+    ports = []
+    counter = [0]
+
+    def wire(prefix):
+        counter[0] += 1
+        w = "%s_%d" % (prefix, counter[0])
+        wires.append(w)
+        return w
+
+    def chain(src, prefix):
+        # Assignments between IO primitives become WIRE instances
+        for _ in range(rng.randint(0, 3)):
+            dst = wire(prefix)
+            lines.append("  assign %s = %s;" % (dst, src))
+            src = dst
+        return src
+
+    def cell(module, inst, conns, params=None):
+        head = module
+        if params:
+            head += " #(\n%s\n  )" % ",\n".join(
+                "    .%s(%s)" % (k, v) for k, v in params)
+        lines.append("  %s %s (\n%s\n  );" % (head, inst, ",\n".join(
+            "    .%s(%s)" % (k, v) for k, v in conns)))
+
+    n_clk = rng.randint(1, 2)
+    n_in = rng.randint(1, 5)
+    n_out = rng.randint(1, 5)
+    data_pins = rng.sample(DATA_PINS, n_in + n_out + n_clk - 1)
+    clock_pins = CLOCK_PINS + data_pins[n_in + n_out:]
+    pins = []
+
+    clocks = []
+    for c in range(n_clk):
+        port = "clk%d" % c
+        ports.append(("input", port))
+        pins.append((port, clock_pins[c]))
+        buf = wire("clk_i")
+        cell("I_BUF", "clk_ibuf%d" % c, [("EN", "1'h1"), ("I", port), ("O", buf)],
+             [("WEAK_KEEPER", '"PULLDOWN"')] if rng.random() < 0.5 else None)
+        clk = wire("clk_buf")
+        cell("CLK_BUF", "clock_buffer%d" % c, [("I", chain(buf, "clk_w")), ("O", clk)])
+        clocks.append(clk)
+
+    data = []
+    for i in range(n_in):
+        port = "din%d" % i
+        ports.append(("input", port))
+        pins.append((port, data_pins[i]))
+        buf = wire("din_buf")
+        cell("I_BUF", "data_ibuf%d" % i, [("EN", "1'h1"), ("I", port), ("O", buf)])
+        src = chain(buf, "din_w")
+        if rng.random() < 0.4:
+            dly = wire("din_dly")
+            cell("I_DELAY", "data_i_delay%d" % i,
+                 [("CLK_IN", rng.choice(clocks)), ("DLY_ADJ", "1'h0"), ("DLY_INCDEC", "1'h0"),
+                  ("DLY_LOAD", "1'h0"), ("I", src), ("O", dly)],
+                 [("DELAY", "32'h%08x" % rng.randint(0, 63))])
+            src = dly
+        data.append(src)
+
+    regs = []
+    for r in range(n_out + rng.randint(0, 2)):
+        q = wire("q")
+        cell("DFFRE", "q_reg%d" % r, [("C", rng.choice(clocks)), ("D", rng.choice(data + regs)),
+                                       ("E", "1'h1"), ("Q", q), ("R", "1'h1")])
+        regs.append(q)
+        # Fabric clocks driven by a register, used by the registers after it
+        if rng.random() < 0.25:
+            fclk = wire("fclk")
+            cell("FCLK_BUF", "fclk_buf%d" % r, [("I", chain(q, "fclk_w")), ("O", fclk)])
+            clocks.append(fclk)
+
+    for o in range(n_out):
+        port = "dout%d" % o
+        ports.append(("output", port))
+        pins.append((port, data_pins[n_in + o]))
+        cell("O_BUF", "data_obuf%d" % o, [("I", chain(rng.choice(regs), "dout_w")), ("O", port)])
+
+    text = "module %s(%s);\n" % (name, ", ".join(p for _, p in ports))
+    text += "".join("  %s %s;\n" % (d, p) for d, p in ports)
+    text += "".join("  wire %s;\n" % w for w in wires)
+    text += "\n".join(lines) + "\nendmodule\n"
+    pin_text = "".join("set_pin_loc %s %s\n" % p for p in pins)
+    return text, pin_text
+
+
+def run_plugin(yosys, plugin, models, design_dir, out_dir):
+    """Runs one test directory with the given plugin, keeps its outputs
+    in out_dir. Returns the yosys log on failure."""
+    shutil.copytree(design_dir, out_dir)
+    os.makedirs(os.path.join(out_dir, "tmp"), exist_ok=True)
+    name = os.path.basename(design_dir)
+    ys = os.path.join(design_dir, name + ".ys")
+    if os.path.exists(ys):
+        with open(ys) as f:
+            script = f.read()
+        # The cell models are found relative to the test directory
+        script = re.sub(r"\S*" + re.escape(CELL_MODELS), models, script)
+        script = script.replace("plugin -i design-edit", "plugin -i " + plugin)
+    else:
+        script = SCRIPT.format(models=models, name=name, plugin=plugin)
+    with open(os.path.join(out_dir, "compare.ys"), "w") as f:
+        f.write(script)
+    res = subprocess.run([yosys, "-s", "compare.ys"], cwd=out_dir,
+                         stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    return res.stdout if res.returncode != 0 else None
+
+
+def read_output(path):
+    if not os.path.exists(path):
+        return None
+    with open(path) as f:
+        return f.readlines()
+
+
+def compare(args, design_dir, work_dir):
+    """Returns a list of differences of the two plugins on one design."""
+    name = os.path.basename(design_dir)
+    dirs = {}
+    for side, plugin in (("before", args.before), ("after", args.after)):
+        dirs[side] = os.path.join(work_dir, side, name)
+        log = run_plugin(args.yosys, plugin, args.models, design_dir, dirs[side])
+        if log is not None:
+            return ["yosys failed with the %s plugin:\n%s" % (side, log[-2000:])]
+    diffs = []
+    for output in OUTPUTS:
+        before = read_output(os.path.join(dirs["before"], output))
+        after = read_output(os.path.join(dirs["after"], output))
+        if before != after:
+            diffs.append("".join(difflib.unified_diff(
+                before or [], after or [], "before/" + output, "after/" + output)) or
+                "%s written by one plugin only" % output)
+    return diffs
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--before", required=True, help="plugin before the change")
+    parser.add_argument("--after", required=True, help="plugin after the change")
+    parser.add_argument("--yosys", default=shutil.which("yosys") or "yosys")
+    parser.add_argument("--models", default=os.path.join(HERE, "..", CELL_MODELS),
+                        help="cell_sim_blackbox.v of the genesis3 primitives")
+    parser.add_argument("--random", type=int, default=100, help="number of generated designs")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--no-tests", action="store_true", help="skip the cases of Tests/")
+    parser.add_argument("--work-dir", default=os.path.join(HERE, "compare_work"))
+    args = parser.parse_args()
+    args.before = os.path.abspath(args.before)
+    args.after = os.path.abspath(args.after)
+    args.models = os.path.abspath(args.models)
+
+    if os.path.exists(args.work_dir):
+        shutil.rmtree(args.work_dir)
+    gen_dir = os.path.join(args.work_dir, "designs")
+
+    designs = []
+    if not args.no_tests:
+        designs += sorted(os.path.dirname(ys) for ys in glob.glob(os.path.join(HERE, "Tests", "*", "*.ys")))
+    rng = random.Random(args.seed)
+    for i in range(args.random):
+        name = "random_%d" % i
+        design_dir = os.path.join(gen_dir, name)
+        os.makedirs(os.path.join(design_dir, "rtl"))
+        verilog, pins = generate(name, rng)
+        with open(os.path.join(design_dir, "rtl", name + ".v"), "w") as f:
+            f.write(verilog)
+        with open(os.path.join(design_dir, "pin_constraints.pin"), "w") as f:
+            f.write(pins)
+        designs.append(design_dir)
+
+    failed = 0
+    for design_dir in designs:
+        name = os.path.basename(design_dir)
+        diffs = compare(args, design_dir, args.work_dir)
+        if diffs:
+            failed += 1
+            print("DIFF %s" % name)
+            for d in diffs:
+                print(d)
+        else:
+            print("SAME %s" % name)
+            for side in ("before", "after"):
+                shutil.rmtree(os.path.join(args.work_dir, side, name))
+    print("%d of %d designs differ" % (failed, len(designs)))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,152 @@
+/**
+ * @file io_instance_table.cc
+ * @brief Instances of the wrapped design, the content of the IO config
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "io_instance_table.h"
+
+#include <set>
+
+#include "kernel/log.h"
+
+uint32_t IO_INSTANCE_TABLE::intern(const std::string& str) {
+  auto res = m_ids.emplace(str, (uint32_t)(m_strings.size()));
+  if (res.second) {
+    m_strings.push_back(&res.first->first);
+  }
+  return res.first->second;
+}
+
+uint32_t IO_INSTANCE_TABLE::find(const std::string& str) const {
+  auto iter = m_ids.find(str);
+  return iter == m_ids.end() ? NO_ID : iter->second;
+}
+
+size_t IO_INSTANCE_TABLE::add_instance(const std::string& module,
+                                       const std::string& name) {
+  m_modules.push_back(intern(module));
+  m_names.push_back(intern(name));
+  m_connection_begins.push_back(m_ports.size());
+  m_linked_objects.push_back(NO_ID);
+  m_canonical_objects.push_back(NO_ID);
+  m_directions.push_back(NO_ID);
+  m_indexes.push_back(0);
+  return size() - 1;
+}
+
+void IO_INSTANCE_TABLE::add_connection(const std::string& port,
+                                       const std::vector<std::string>& nets) {
+  log_assert(size());
+  uint32_t port_id = intern(port);
+  size_t net_begin = m_nets.size();
+  if (nets.size() == 0) {
+    m_nets.push_back(intern(""));
+  } else {
+    for (auto& net : nets) {
+      m_nets.push_back(intern(net));
+    }
+  }
+  uint32_t net_count = (uint32_t)(m_nets.size() - net_begin);
+  // Keep the connections of the instance sorted by port name, a port
+  // connected again replaces the previous connection
+  size_t conn = m_connection_begins.back();
+  while (conn < m_ports.size() && str(m_ports[conn]) < port) {
+    conn++;
+  }
+  if (conn < m_ports.size() && m_ports[conn] == port_id) {
+    m_net_begins[conn] = net_begin;
+    m_net_counts[conn] = net_count;
+    return;
+  }
+  m_ports.insert(m_ports.begin() + conn, port_id);
+  m_net_begins.insert(m_net_begins.begin() + conn, net_begin);
+  m_net_counts.insert(m_net_counts.begin() + conn, net_count);
+}
+
+size_t IO_INSTANCE_TABLE::find_connection(size_t inst, uint32_t port) const {
+  if (port == NO_ID) {
+    return NO_CONNECTION;
+  }
+  for (size_t conn = connection_begin(inst); conn < connection_end(inst);
+       conn++) {
+    if (m_ports[conn] == port) {
+      return conn;
+    }
+  }
+  return NO_CONNECTION;
+}
+
+void IO_INSTANCE_TABLE::link(size_t inst, uint32_t object, uint32_t direction,
+                             uint32_t index) {
+  m_linked_objects[inst] = object;
+  m_canonical_objects[inst] = canonical(object);
+  m_directions[inst] = direction;
+  m_indexes[inst] = index;
+}
+
+uint32_t IO_INSTANCE_TABLE::canonical(uint32_t object) {
+  if (object < m_canonicals.size() && m_canonicals[object] != NO_ID) {
+    return m_canonicals[object];
+  }
+  uint32_t canonical_object = object;
+  const std::string& names = str(object);
+  if (names.find('+') != std::string::npos) {
+    std::set<std::string> sorted_names;
+    size_t begin = 0;
+    for (size_t end = names.find('+'); end != std::string::npos;
+         end = names.find('+', begin)) {
+      sorted_names.insert(names.substr(begin, end - begin));
+      begin = end + 1;
+    }
+    sorted_names.insert(names.substr(begin));
+    std::string sorted = "";
+    for (auto& name : sorted_names) {
+      if (sorted.size()) {
+        sorted.push_back('+');
+      }
+      sorted.append(name);
+    }
+    canonical_object = intern(sorted);
+  }
+  if (m_canonicals.size() <= object) {
+    m_canonicals.resize(object + 1, NO_ID);
+  }
+  m_canonicals[object] = canonical_object;
+  return canonical_object;
+}
+
+nlohmann::json IO_INSTANCE_TABLE::to_json() const {
+  nlohmann::json instances = nlohmann::json::array();
+  for (size_t inst = 0; inst < size(); inst++) {
+    nlohmann::json instance;
+    instance["module"] = str(m_modules[inst]);
+    instance["name"] = str(m_names[inst]);
+    // An instance without connections has always been written with a null
+    // connectivity
+    nlohmann::json& connectivity = instance["connectivity"];
+    for (size_t conn = connection_begin(inst); conn < connection_end(inst);
+         conn++) {
+      if (is_bus(conn)) {
+        nlohmann::json nets = nlohmann::json::array();
+        for (size_t i = 0; i < net_count(conn); i++) {
+          nets.push_back(str(net(conn, i)));
+        }
+        connectivity[str(m_ports[conn])] = std::move(nets);
+      } else {
+        connectivity[str(m_ports[conn])] = str(net(conn));
+      }
+    }
+    if (is_linked(inst)) {
+      instance["linked_object"] = str(m_linked_objects[inst]);
+    }
+    if (m_directions[inst] != NO_ID) {
+      instance["direction"] = str(m_directions[inst]);
+      instance["index"] = m_indexes[inst];
+    }
+    instances.push_back(std::move(instance));
+  }
+  nlohmann::json io_config = nlohmann::json::object();
+  io_config["instances"] = std::move(instances);
+  return io_config;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file io_instance_table.h
+ * @brief Instances of the wrapped design, the content of the IO config
+ *
+ * @copyright Copyright (c) 2026
+ */
+#ifndef IO_INSTANCE_TABLE_H
+#define IO_INSTANCE_TABLE_H
+
+#include <json.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+  Instances of the wrapped design stored column by column. Module, instance,
+  port and net names and linked objects are interned, so comparing them is
+  comparing numbers. Connections of an instance are sorted by port name, the
+  order of the "connectivity" object of the IO config. JSON is only built
+  for output
+*/
+class IO_INSTANCE_TABLE {
+ public:
+  static constexpr uint32_t NO_ID = UINT32_MAX;
+  static constexpr size_t NO_CONNECTION = SIZE_MAX;
+
+  uint32_t intern(const std::string& str);
+  // NO_ID if the string was never interned
+  uint32_t find(const std::string& str) const;
+  const std::string& str(uint32_t id) const { return *m_strings[id]; }
+  size_t string_count() const { return m_strings.size(); }
+
+  size_t size() const { return m_modules.size(); }
+  size_t add_instance(const std::string& module, const std::string& name);
+  // Connects a port of the last added instance. A single net is stored as a
+  // scalar connection, no net as an unconnected port ("")
+  void add_connection(const std::string& port,
+                      const std::vector<std::string>& nets);
+
+  uint32_t module(size_t inst) const { return m_modules[inst]; }
+  uint32_t name(size_t inst) const { return m_names[inst]; }
+
+  // Connections of an instance are [connection_begin, connection_end)
+  size_t connection_begin(size_t inst) const {
+    return m_connection_begins[inst];
+  }
+  size_t connection_end(size_t inst) const {
+    return inst + 1 < size() ? m_connection_begins[inst + 1] : m_ports.size();
+  }
+  size_t find_connection(size_t inst, uint32_t port) const;
+  uint32_t port(size_t conn) const { return m_ports[conn]; }
+  // Connected to a list of nets rather than to one
+  bool is_bus(size_t conn) const { return m_net_counts[conn] > 1; }
+  size_t net_count(size_t conn) const { return m_net_counts[conn]; }
+  uint32_t net(size_t conn, size_t i = 0) const {
+    return m_nets[m_net_begins[conn] + i];
+  }
+
+  bool is_linked(size_t inst) const { return m_linked_objects[inst] != NO_ID; }
+  uint32_t linked_object(size_t inst) const { return m_linked_objects[inst]; }
+  // The objects of the linked object sorted and without duplicates, the
+  // way PRIMITIVES_EXTRACTOR names them ("a+b")
+  uint32_t canonical_linked_object(size_t inst) const {
+    return m_canonical_objects[inst];
+  }
+  uint32_t direction(size_t inst) const { return m_directions[inst]; }
+  uint32_t index(size_t inst) const { return m_indexes[inst]; }
+  void link(size_t inst, uint32_t object, uint32_t direction, uint32_t index);
+
+  // {"instances": [...]}
+  nlohmann::json to_json() const;
+
+ private:
+  uint32_t canonical(uint32_t object);
+
+  std::unordered_map<std::string, uint32_t> m_ids;
+  std::vector<const std::string*> m_strings;
+  std::vector<uint32_t> m_canonicals;  // by string ID, NO_ID if not known yet
+  // Per instance
+  std::vector<uint32_t> m_modules;
+  std::vector<uint32_t> m_names;
+  std::vector<size_t> m_connection_begins;
+  std::vector<uint32_t> m_linked_objects;
+  std::vector<uint32_t> m_canonical_objects;
+  std::vector<uint32_t> m_directions;
+  std::vector<uint32_t> m_indexes;
+  // Per connection
+  std::vector<uint32_t> m_ports;
+  std::vector<size_t> m_net_begins;
+  std::vector<uint32_t> m_net_counts;
+  std::vector<uint32_t> m_nets;
+};
+
+#endif
@@ -69,6 +69,7 @@
 */
 
 #include "primitives_extractor.h"
+#include "io_instance_table.h"
 
 #include <algorithm>
 #include <regex>
@@ -221,6 +222,18 @@ std::string sort_name(std::string names) {
   return names;
 }
 
+/*
+  Join the objects with "+", sorted
+*/
+std::string join_linked_objects(const std::vector<std::string>& objects) {
+  std::string name = "";
+  for (auto& o : objects) {
+    name = stringf("%s+%s", name.c_str(), o.c_str());
+  }
+  name.erase(0, 1);
+  return sort_name(name);
+}
+
 /*
   Get rid the first and last character if they are '"'
 */
@@ -661,20 +674,9 @@ struct PORT_PRIMITIVE : PRIMITIVE {
           g_standalone_tracker[standalone_name] + 1;
       standalone_name = stringf("%s#%d", standalone_name.c_str(), index);
     }
+    sorted_linked_object = join_linked_objects(linked_objects());
   }
-  std::string linked_object() const {
-    std::string name = "";
-    if (db->is_standalone() || db->is_fabric_clkbuf()) {
-      name = standalone_name;
-    } else {
-      for (auto port : port_infos) {
-        name = stringf("%s+%s", name.c_str(),
-                       get_original_name(port.realname).c_str());
-      }
-      name.erase(0, 1);
-    }
-    return sort_name(name);
-  }
+  const std::string& linked_object() const { return sorted_linked_object; }
   std::vector<std::string> linked_objects() const {
     std::vector<std::string> names;
     if (db->is_standalone() || db->is_fabric_clkbuf()) {
@@ -690,6 +692,8 @@ struct PORT_PRIMITIVE : PRIMITIVE {
   const std::vector<PORT_INFO> port_infos;
   const IO_DIR dir = IO_DIR::UNKNOWN;
   std::string standalone_name = "";
+  // linked_objects() sorted and joined with "+", computed once
+  std::string sorted_linked_object = "";
   int chain_data_width = -2;
 };
 
@@ -704,6 +708,7 @@ struct INSTANCE {
       : module(get_original_name(m)),
         name(get_original_name(n)),
         linked_objects(ls),
+        sorted_linked_object(join_linked_objects(ls)),
         primitive(p),
         pre_primitive(pre),
         post_primitives(post) {
@@ -731,14 +736,7 @@ struct INSTANCE {
       parameters[get_original_name(iter.first)] = get_param_string(iter.second);
     }
   }
-  std::string linked_object() const {
-    std::string name = "";
-    for (auto o : linked_objects) {
-      name = stringf("%s+%s", name.c_str(), o.c_str());
-    }
-    name.erase(0, 1);
-    return sort_name(name);
-  }
+  const std::string& linked_object() const { return sorted_linked_object; }
   static uint8_t parse_location(const std::string& location,
                                 PARSED_LOCATION& parsed) {
     log_assert(parsed.type.size() == 0 && parsed.bank.size() == 0 &&
@@ -876,6 +874,8 @@ struct INSTANCE {
   const std::string module = "";
   const std::string name = "";
   const std::vector<std::string> linked_objects;
+  // linked_objects sorted and joined with "+", computed once
+  const std::string sorted_linked_object = "";
   const PRIMITIVE* primitive = nullptr;
   const std::string pre_primitive = "";
   const std::vector<std::string> post_primitives;
@@ -2819,9 +2819,10 @@ void PRIMITIVES_EXTRACTOR::write_json_data(const std::string& str,
 /*
   Write out fabric clock or mode SDC
 */
-void PRIMITIVES_EXTRACTOR::write_sdc(const std::string& sdc_file,
-                                     const std::string& clk_pin_xml,
-                                     const nlohmann::json& wrapped_instances) {
+void PRIMITIVES_EXTRACTOR::write_sdc(
+    const std::string& sdc_file, const std::string& clk_pin_xml,
+    const IO_INSTANCE_TABLE& instances) {
+  WRAPPED_INSTANCE_INDEX wrapped_instances(instances);
 #if ENABLE_INSTANCE_CROSS_CHECK
   POST_MSG(1, "Cross-check instances vs wrapped-instances");
   for (auto& inst : m_instances) {
@@ -2884,116 +2885,146 @@ std::string PRIMITIVES_EXTRACTOR::get_assigned_location(
 }
 
 /*
-  Get the wrapped instance
+  Index the wrapped instances for the SDC queries
+*/
+WRAPPED_INSTANCE_INDEX::WRAPPED_INSTANCE_INDEX(
+    const IO_INSTANCE_TABLE& wrapped_instances)
+    : instances(wrapped_instances) {
+  uint32_t wire = instances.find("WIRE");
+  uint32_t wire_in = instances.find("I");
+  uint32_t wire_out = instances.find("O");
+  for (size_t i = 0; i < instances.size(); i++) {
+    // Full name and every hierarchical suffix, first instance wins
+    const std::string& name = instances.str(instances.name(i));
+    names.emplace(name, i);
+    for (size_t dot = name.find('.', 1); dot != std::string::npos;
+         dot = name.find('.', dot + 1)) {
+      names.emplace(name.substr(dot + 1), i);
+    }
+    const std::string& module = instances.str(instances.module(i));
+    if (instances.module(i) == wire) {
+      size_t in = instances.find_connection(i, wire_in);
+      size_t out = instances.find_connection(i, wire_out);
+      if (in != IO_INSTANCE_TABLE::NO_CONNECTION &&
+          out != IO_INSTANCE_TABLE::NO_CONNECTION) {
+        if (!instances.is_bus(in)) {
+          wires_by_input[instances.net(in)].push_back(i);
+        }
+        if (!instances.is_bus(out)) {
+          wires_by_output[instances.net(out)].push_back(i);
+        }
+      }
+    }
+    // All instance are either primitive or WIRE or fabric
+    // primitive and WIRE module name is fix
+    // for fabric, the module name format is "fabric_<project>"
+    if (fabric == SIZE_MAX &&
+        module.find("fabric_") == 0) {
+      fabric = i;
+      for (size_t conn = instances.connection_begin(i);
+           conn < instances.connection_end(i); conn++) {
+        fabric_ports.insert(instances.port(conn));
+      }
+    }
+    if (instances.is_linked(i)) {
+      linked_instances.emplace(
+          std::make_pair(instances.module(i),
+                         instances.canonical_linked_object(i)),
+          i);
+    }
+  }
+}
+
+/*
+  Follow the WIRE instances from net, each one after the previous in
+  instance order
 */
-size_t PRIMITIVES_EXTRACTOR::get_wrapped_instance(
-    const nlohmann::json& wrapped_instances, const std::string& name) {
-  log_assert(name.size());
-  size_t index = 0;
-  bool found = false;
-  for (auto& inst : wrapped_instances) {
-    std::string inst_name = (std::string)(inst["name"]);
-    if (inst_name == name || ((inst_name.size() > (name.size() + 1)) &&
-                              (inst_name.rfind("." + name) ==
-                               (inst_name.size() - name.size() - 1)))) {
-      found = true;
+uint32_t WRAPPED_INSTANCE_INDEX::follow_wires(uint32_t net,
+                                              bool from_input) const {
+  const auto& wires = from_input ? wires_by_input : wires_by_output;
+  uint32_t port = instances.find(from_input ? "O" : "I");
+  size_t last = 0;
+  bool first = true;
+  while (true) {
+    auto iter = wires.find(net);
+    if (iter == wires.end()) {
       break;
     }
-    index++;
+    auto next = first ? iter->second.begin()
+                      : std::upper_bound(iter->second.begin(),
+                                         iter->second.end(), last);
+    if (next == iter->second.end()) {
+      break;
+    }
+    last = *next;
+    first = false;
+    net = instances.net(instances.find_connection(last, port));
   }
-  log_assert(found);
-  return index;
+  return net;
+}
+
+bool WRAPPED_INSTANCE_INDEX::is_fabric_port(const std::string& net) const {
+  return fabric_ports.count(instances.find(net)) > 0;
+}
+
+/*
+  Get the wrapped instance
+*/
+size_t PRIMITIVES_EXTRACTOR::get_wrapped_instance(
+    const WRAPPED_INSTANCE_INDEX& wrapped_instances, const std::string& name) {
+  log_assert(name.size());
+  auto iter = wrapped_instances.names.find(name);
+  log_assert(iter != wrapped_instances.names.end());
+  return iter->second;
 }
 
 /*
   Get the wrapped instance's input net
 */
 std::string PRIMITIVES_EXTRACTOR::get_input_wrapped_net(
-    const nlohmann::json& wrapped_instances, size_t index,
+    const WRAPPED_INSTANCE_INDEX& wrapped_instances, size_t index,
     const FABRIC_CLOCK* clk) {
-  log_assert(wrapped_instances.is_array());
-  log_assert(index < wrapped_instances.size());
-  const nlohmann::json& instance = wrapped_instances[index];
-  log_assert(instance["connectivity"].contains(clk->iport));
-  std::string wrapped_net = instance["connectivity"][clk->iport];
-  log_assert(wrapped_net.size());
+  const IO_INSTANCE_TABLE& instances = wrapped_instances.instances;
+  log_assert(index < instances.size());
+  size_t conn = instances.find_connection(index, instances.find(clk->iport));
+  log_assert(conn != IO_INSTANCE_TABLE::NO_CONNECTION);
+  log_assert(!instances.is_bus(conn));
+  uint32_t wrapped_net = instances.net(conn);
+  log_assert(instances.str(wrapped_net).size());
   // Any subsequence wire
-  for (auto& instance : wrapped_instances) {
-    if (instance["module"] == "WIRE" /*&&
-        ((clk->is_fabric_clkbuf) ||
-         (instance.contains("linked_object") &&
-          sort_name(instance["linked_object"]) == clk->linked_object))*/) {
-      if (instance["connectivity"]["O"] == wrapped_net) {
-        wrapped_net = instance["connectivity"]["I"];
-      }
-    }
+  wrapped_net = wrapped_instances.follow_wires(wrapped_net, false);
+  if (!wrapped_instances.is_fabric_port(instances.str(wrapped_net))) {
+    return "";
   }
-  bool found = false;
-  for (auto& fabric : wrapped_instances) {
-    // All instance are either primitive or WIRE or fabric
-    // primitive and WIRE module name is fix
-    // for fabric, the module name format is "fabric_<project>"
-    if (((std::string)(fabric["module"])).find("fabric_") == 0) {
-      if (fabric["connectivity"].contains(wrapped_net)) {
-        // good
-        found = true;
-      }
-      break;
-    }
-  }
-  if (!found) {
-    wrapped_net = "";
-  }
-  return wrapped_net;
+  return instances.str(wrapped_net);
 }
 
 /*
   Get the wrapped instance's output net
 */
 std::string PRIMITIVES_EXTRACTOR::get_output_wrapped_net(
-    const nlohmann::json& wrapped_instances, size_t index,
+    const WRAPPED_INSTANCE_INDEX& wrapped_instances, size_t index,
     const FABRIC_CLOCK* clk) {
-  log_assert(wrapped_instances.is_array());
-  log_assert(index < wrapped_instances.size());
-  const nlohmann::json& instance = wrapped_instances[index];
-  log_assert(instance["connectivity"].contains(clk->oport));
-  std::string wrapped_net = instance["connectivity"][clk->oport];
-  log_assert(wrapped_net.size());
+  const IO_INSTANCE_TABLE& instances = wrapped_instances.instances;
+  log_assert(index < instances.size());
+  size_t conn = instances.find_connection(index, instances.find(clk->oport));
+  log_assert(conn != IO_INSTANCE_TABLE::NO_CONNECTION);
+  log_assert(!instances.is_bus(conn));
+  uint32_t wrapped_net = instances.net(conn);
+  log_assert(instances.str(wrapped_net).size());
   // Any subsequence wire
-  for (auto& instance : wrapped_instances) {
-    if (instance["module"] == "WIRE" /*&&
-        ((clk->is_fabric_clkbuf) ||
-         (instance.contains("linked_object") &&
-          sort_name(instance["linked_object"]) == clk->linked_object))*/) {
-      if (instance["connectivity"]["I"] == wrapped_net) {
-        wrapped_net = instance["connectivity"]["O"];
-      }
-    }
-  }
-  bool found = false;
-  for (auto& fabric : wrapped_instances) {
-    // All instance are either primitive or WIRE or fabric
-    // primitive and WIRE module name is fix
-    // for fabric, the module name format is "fabric_<project>"
-    if (((std::string)(fabric["module"])).find("fabric_") == 0) {
-      if (fabric["connectivity"].contains(wrapped_net)) {
-        // good
-        found = true;
-      }
-      break;
-    }
+  wrapped_net = wrapped_instances.follow_wires(wrapped_net, true);
+  if (!wrapped_instances.is_fabric_port(instances.str(wrapped_net))) {
+    return "";
   }
-  if (!found) {
-    wrapped_net = "";
-  }
-  return wrapped_net;
+  return instances.str(wrapped_net);
 }
 
 /*
   Get the fabric data of the last data primitive
 */
 std::string PRIMITIVES_EXTRACTOR::get_fabric_data(
-    const nlohmann::json& wrapped_instances, const std::string& object,
+    const WRAPPED_INSTANCE_INDEX& wrapped_instances, const std::string& object,
     std::vector<std::string>& data_nets, std::vector<bool>& found_nets,
     const bool input, bool& not_an_error) {
   log_assert(data_nets.size() == 0);
@@ -3095,34 +3126,27 @@ std::string PRIMITIVES_EXTRACTOR::get_fabric_data(
 */
 std::pair<std::string, std::string>
 PRIMITIVES_EXTRACTOR::get_wrapped_instance_net_by_port(
-    const nlohmann::json& wrapped_instances, const std::string& module,
-    const std::string& linked_object, const std::string& port,
+    const WRAPPED_INSTANCE_INDEX& wrapped_instances,
+    const std::string& module, const std::string& linked_object,
+    const std::string& port,
     std::vector<std::string>& nets) {
   log_assert(nets.size() == 0);
   bool found_instance = false;
   bool found_port = false;
   std::pair<std::string, std::string> reason("", "");
-  for (auto& instance : wrapped_instances) {
-    if (instance["module"] == module && instance.contains("linked_object") &&
-        sort_name(instance["linked_object"]) == linked_object) {
-      found_instance = true;
-      for (auto iter : instance["connectivity"].items()) {
-        std::string key = iter.key();
-        nlohmann::json value = iter.value();
-        if (key == port) {
-          found_port = true;
-          if (value.is_array()) {
-            for (nlohmann::json v : value) {
-              log_assert(v.is_string());
-              nets.push_back((std::string)(v));
-            }
-          } else {
-            log_assert(value.is_string());
-            nets.push_back((std::string)(value));
-          }
-        }
+  const IO_INSTANCE_TABLE& instances = wrapped_instances.instances;
+  // linked_object is sorted already
+  auto iter = wrapped_instances.linked_instances.find(
+      std::make_pair(instances.find(module), instances.find(linked_object)));
+  if (iter != wrapped_instances.linked_instances.end()) {
+    found_instance = true;
+    size_t conn =
+        instances.find_connection(iter->second, instances.find(port));
+    if (conn != IO_INSTANCE_TABLE::NO_CONNECTION) {
+      found_port = true;
+      for (size_t j = 0; j < instances.net_count(conn); j++) {
+        nets.push_back(instances.str(instances.net(conn, j)));
       }
-      break;
     }
   }
   if (found_instance) {
@@ -3152,19 +3176,20 @@ PRIMITIVES_EXTRACTOR::get_wrapped_instance_net_by_port(
   Get the subsequent potential wire
 */
 void PRIMITIVES_EXTRACTOR::get_wrapped_instance_potential_next_wire(
-    const nlohmann::json& wrapped_instances, const std::string& src,
+    const WRAPPED_INSTANCE_INDEX& wrapped_instances, const std::string& src,
     const std::string& dest, std::vector<std::string>& nets) {
   log_assert(src == "I" || src == "O");
   log_assert(dest == "I" || dest == "O");
   log_assert(src != dest);
+  const IO_INSTANCE_TABLE& instances = wrapped_instances.instances;
+  const auto& wires = src == "I" ? wrapped_instances.wires_by_input
+                                 : wrapped_instances.wires_by_output;
+  uint32_t dest_port = instances.find(dest);
   for (size_t i = 0; i < nets.size(); i++) {
-    for (auto& instance : wrapped_instances) {
-      if (instance["module"] == "WIRE") {
-        if (instance["connectivity"][src] == nets[i]) {
-          nets[i] = instance["connectivity"][dest];
-          break;
-        }
-      }
+    auto iter = wires.find(instances.find(nets[i]));
+    if (iter != wires.end()) {
+      nets[i] = instances.str(instances.net(
+          instances.find_connection(iter->second.front(), dest_port)));
     }
   }
 }
@@ -3173,19 +3198,12 @@ void PRIMITIVES_EXTRACTOR::get_wrapped_instance_potential_next_wire(
   Make sure the net exists as port of the fabric
 */
 std::vector<bool> PRIMITIVES_EXTRACTOR::check_fabric_port(
-    const nlohmann::json& wrapped_instances,
+    const WRAPPED_INSTANCE_INDEX& wrapped_instances,
     const std::vector<std::string> nets) {
   std::vector<bool> founds;
-  for (auto& fabric : wrapped_instances) {
-    // All instance are either primitive or WIRE or fabric
-    // primitive and WIRE module name is fix
-    // for fabric, the module name format is "fabric_<project>"
-    if (((std::string)(fabric["module"])).find("fabric_") == 0) {
-      for (auto& net : nets) {
-        founds.push_back(fabric.contains("connectivity") &&
-                         fabric["connectivity"].contains(net));
-      }
-      break;
+  if (wrapped_instances.fabric != SIZE_MAX) {
+    for (auto& net : nets) {
+      founds.push_back(wrapped_instances.is_fabric_port(net));
     }
   }
   return founds;
@@ -3209,7 +3227,7 @@ void PRIMITIVES_EXTRACTOR::file_write_string(std::ofstream& file,
 */
 void PRIMITIVES_EXTRACTOR::write_fabric_clock(
     std::ofstream& sdc, std::ofstream& xml,
-    const nlohmann::json& wrapped_instances) {
+    const WRAPPED_INSTANCE_INDEX& wrapped_instances) {
   POST_MSG(2, "Determine fabric clock");
   sdc << "#############\n";
   sdc << "#\n";
@@ -3313,7 +3331,7 @@ void PRIMITIVES_EXTRACTOR::write_fabric_clock(
   Write out data signal mode and location
 */
 void PRIMITIVES_EXTRACTOR::write_data_mode_and_location(
-    std::ofstream& sdc, const nlohmann::json& wrapped_instances) {
+    std::ofstream& sdc, const WRAPPED_INSTANCE_INDEX& wrapped_instances) {
   POST_MSG(2, "Determine data pin mode and location");
   sdc << "#############\n";
   sdc << "#\n";
@@ -3430,7 +3448,7 @@ void PRIMITIVES_EXTRACTOR::write_data_mode_and_location(
 }
 
 void PRIMITIVES_EXTRACTOR::write_control_signal(
-    std::ofstream& sdc, const nlohmann::json& wrapped_instances) {
+    std::ofstream& sdc, const WRAPPED_INSTANCE_INDEX& wrapped_instances) {
   POST_MSG(2, "Determine internal control signals");
   POST_MSG(3, "Group signals by location");
   std::map<std::string, std::vector<std::string>> tracked_signals;
@@ -2,8 +2,11 @@
 #define PRIMITIVES_EXTRACTOR_H
 
 #include <json.hpp>
+#include <cstdint>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "kernel/rtlil.h"
@@ -48,6 +51,7 @@ struct PORT_PRIMITIVE;
 struct INSTANCE;
 struct PIN_PORT;
 struct FABRIC_CLOCK;
+class IO_INSTANCE_TABLE;
 
 /*
   Both structures are for SDC
@@ -85,6 +89,28 @@ struct PARSED_LOCATION {
   std::string failure_reason = "";
 };
 
+/*
+  Lookups into the wrapped instances (IO config), built once per SDC
+*/
+struct WRAPPED_INSTANCE_INDEX {
+  WRAPPED_INSTANCE_INDEX(const IO_INSTANCE_TABLE& wrapped_instances);
+  // Net reached through the WIRE instances connected one after the other,
+  // from their I to their O (from_input) or the other way
+  uint32_t follow_wires(uint32_t net, bool from_input) const;
+  bool is_fabric_port(const std::string& net) const;
+  const IO_INSTANCE_TABLE& instances;
+  // Instance by name or by any suffix after a "."
+  std::unordered_map<std::string, size_t> names;
+  // WIRE instances by the net of their I or O, in instance order
+  std::unordered_map<uint32_t, std::vector<size_t>> wires_by_input;
+  std::unordered_map<uint32_t, std::vector<size_t>> wires_by_output;
+  // First fabric instance and its ports, which are named after the nets
+  size_t fabric = SIZE_MAX;
+  std::unordered_set<uint32_t> fabric_ports;
+  // First instance by module and canonical linked object
+  std::map<std::pair<uint32_t, uint32_t>, size_t> linked_instances;
+};
+
 class PRIMITIVES_EXTRACTOR {
  public:
   PRIMITIVES_EXTRACTOR(const std::string& technology);
@@ -97,7 +123,7 @@ class PRIMITIVES_EXTRACTOR {
       const std::string& name, bool unique_location = false);
   void write_json(const std::string& file);
   void write_sdc(const std::string& sdc_file, const std::string& clk_pin_xml,
-                 const nlohmann::json& wrapped_instances);
+                 const IO_INSTANCE_TABLE& instances);
   static void get_signals(const Yosys::RTLIL::SigSpec& sig,
                           std::vector<std::string>& signals);
   static bool is_real_net(const std::string& net);
@@ -175,37 +201,41 @@ class PRIMITIVES_EXTRACTOR {
   void write_json_data(const std::string& str, std::ofstream& json);
   std::string get_assigned_location(SDC_ENTRY*& entry, const std::string& rule,
                                     const PARSED_LOCATION& parsed_location);
-  size_t get_wrapped_instance(const nlohmann::json& wrapped_instances,
+  size_t get_wrapped_instance(const WRAPPED_INSTANCE_INDEX& wrapped_instances,
                               const std::string& name);
-  std::string get_input_wrapped_net(const nlohmann::json& wrapped_instances,
-                                    size_t index, const FABRIC_CLOCK* clk);
-  std::string get_output_wrapped_net(const nlohmann::json& wrapped_instances,
-                                     size_t index, const FABRIC_CLOCK* clk);
-  std::string get_fabric_data(const nlohmann::json& wrapped_instances,
+  std::string get_input_wrapped_net(
+      const WRAPPED_INSTANCE_INDEX& wrapped_instances, size_t index,
+      const FABRIC_CLOCK* clk);
+  std::string get_output_wrapped_net(
+      const WRAPPED_INSTANCE_INDEX& wrapped_instances, size_t index,
+      const FABRIC_CLOCK* clk);
+  std::string get_fabric_data(const WRAPPED_INSTANCE_INDEX& wrapped_instances,
                               const std::string& object,
                               std::vector<std::string>& data_nets,
                               std::vector<bool>& found_nets, const bool input,
                               bool& not_an_error);
   std::pair<std::string, std::string> get_wrapped_instance_net_by_port(
-      const nlohmann::json& wrapped_instances, const std::string& module,
-      const std::string& linked_object, const std::string& port,
+      const WRAPPED_INSTANCE_INDEX& wrapped_instances,
+      const std::string& module, const std::string& linked_object,
+      const std::string& port,
       std::vector<std::string>& nets);
   void get_wrapped_instance_potential_next_wire(
-      const nlohmann::json& wrapped_instances, const std::string& src,
+      const WRAPPED_INSTANCE_INDEX& wrapped_instances, const std::string& src,
       const std::string& dest, std::vector<std::string>& nets);
-  std::vector<bool> check_fabric_port(const nlohmann::json& wrapped_instances,
-                                      const std::vector<std::string> nets);
+  std::vector<bool> check_fabric_port(
+      const WRAPPED_INSTANCE_INDEX& wrapped_instances,
+      const std::vector<std::string> nets);
   void file_write_string(std::ofstream& file, const std::string& string,
                          int size = -1);
   /*
     All about SDC writing
   */
   void write_fabric_clock(std::ofstream& sdc, std::ofstream& xml,
-                          const nlohmann::json& wrapped_instances);
-  void write_data_mode_and_location(std::ofstream& sdc,
-                                    const nlohmann::json& wrapped_instances);
+                          const WRAPPED_INSTANCE_INDEX& wrapped_instances);
+  void write_data_mode_and_location(
+      std::ofstream& sdc, const WRAPPED_INSTANCE_INDEX& wrapped_instances);
   void write_control_signal(std::ofstream& sdc,
-                            const nlohmann::json& wrapped_instances);
+                            const WRAPPED_INSTANCE_INDEX& wrapped_instances);
   void write_gearbox_core_clock(std::ofstream& sdc);
   void write_sdc_entries(std::ofstream& sdc,
                          std::vector<SDC_ENTRY*>& sdc_entries);
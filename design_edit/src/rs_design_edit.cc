@@ -21,8 +21,11 @@
 #include "rs_design_edit.h"
 #include "rs_primitive.h"
 #include "netlist_checker.h"
+#include "io_instance_table.h"
 #include <json.hpp>
 #include <chrono>
+#include <future>
+#include <queue>
 
 #ifdef PRODUCTION_BUILD
 #include "License_manager.hpp"
@@ -185,36 +188,19 @@ struct DesignEditRapidSilicon : public ScriptPass {
     return output.str();
   }
 
-  void dump_io_config_json(Module* mod, std::string file) {
-    std::ofstream json_file(file.c_str());
-    json instances = json::object();
-    json instances_array = json::array();
+  // Builds the IO config of the wrapped design
+  void dump_io_config_json(Module* mod, IO_INSTANCE_TABLE& instances) {
     for(auto cell : mod->cells()) {
-      json instance_object;
-      instance_object["module"] = remove_backslashes(cell->type.str());
-      instance_object["name"] = remove_backslashes(cell->name.str());
+      instances.add_instance(remove_backslashes(cell->type.str()), remove_backslashes(cell->name.str()));
       for(auto conn : cell->connections()) {
         std::string port_name = remove_backslashes(conn.first.str());
         std::vector<std::string> signals;
         PRIMITIVES_EXTRACTOR::get_signals(conn.second, signals);
-        std::string connection = "";
         for (size_t i = 0; i < signals.size(); i++) {
           signals[i] = remove_backslashes(signals[i]);
         }
-        if (signals.size() == 0) {
-          instance_object["connectivity"][port_name] = "";
-        } else if (signals.size() == 1) {
-          instance_object["connectivity"][port_name] = signals[0];
-          connection = signals[0];
-        } else {
-          // array of signals
-          instance_object["connectivity"][port_name] = nlohmann::json::array();
-          for (auto& s : signals) {
-            instance_object["connectivity"][port_name].push_back(s);
-          }
-        }
+        instances.add_connection(port_name, signals);
       }
-      instances_array.push_back(instance_object);
     }
     // enhancement to auto create wire primitives
     size_t i = 0;
@@ -226,24 +212,23 @@ struct DesignEditRapidSilicon : public ScriptPass {
       log_assert(lefts.size() == rights.size());
       // break the bus into bit by bit
       for (size_t j = 0; j < lefts.size(); j++) {
-        json instance_object;
-        instance_object["module"] = (std::string)("WIRE");
-        instance_object["name"] = (std::string)(stringf("wire%ld", i));
-        instance_object["connectivity"]["I"] = remove_backslashes(rights[j]);
-        instance_object["connectivity"]["O"] = remove_backslashes(lefts[j]);
-        instances_array.push_back(instance_object);
+        instances.add_instance("WIRE", stringf("wire%ld", i));
+        instances.add_connection("I", {remove_backslashes(rights[j])});
+        instances.add_connection("O", {remove_backslashes(lefts[j])});
         i++;
       }
     }
+    net_index data_nets;
+    index_instance_nets(instances, DATA_OUT_PORTS, data_nets);
 #if 0
     // Starting by marking all the "port" primitives
     // IO bitstream generation will only need a unique name to know which primitives are linked together, any name will do
     // But it does not work for other flow, which they use linked_object name as port name
     i = 0;
     std::vector<std::string> port_primitives = {"I_BUF", "I_BUF_DS", "O_BUF", "O_BUFT", "O_BUF_DS", "O_BUFT_DS", "BOOT_CLOCK"};
-    for (auto& inst : instances_array) {
-      if (std::find(port_primitives.begin(), port_primitives.end(), inst["module"]) != port_primitives.end()) {
-        inst["linked_object"] = std::string(stringf("object%ld", i));
+    for (size_t inst = 0; inst < instances.size(); inst++) {
+      if (std::find(port_primitives.begin(), port_primitives.end(), instances.str(instances.module(inst))) != port_primitives.end()) {
+        instances.link(inst, instances.intern(stringf("object%ld", i)), instances.direction(inst), instances.index(inst));
         i++;
       }
     }
@@ -266,186 +251,167 @@ struct DesignEditRapidSilicon : public ScriptPass {
           if (wire->width > 1) {
             portname = stringf("%s[%d]", wire->name.c_str(), wire->start_offset + index);
           }
-          portname = remove_backslashes(portname);
+          uint32_t port = instances.intern(remove_backslashes(portname));
           if (dir == "INOUT") {
-            link_instance(true, instances_array, portname, portname, "IN", 0, true, DATA_OUT_PORTS);
-            link_instance(false, instances_array, portname, portname, "OUT", 0, true, DATA_OUT_PORTS);
+            link_instance(true, instances, data_nets, port, port, instances.intern("IN"), 0, true);
+            link_instance(false, instances, data_nets, port, port, instances.intern("OUT"), 0, true);
           } else {
-            link_instance(dir == "IN", instances_array, portname, portname, dir, 0, true, DATA_OUT_PORTS);
+            link_instance(dir == "IN", instances, data_nets, port, port, instances.intern(dir), 0, true);
           }
         }
       }
     }
 #endif
     // Handle pure-data
-    link_instance_recursively(instances_array, 0, DATA_OUT_PORTS);
+    link_instance_recursively(instances, data_nets, DATA_OUT_PORTS);
     // Handle clock
     for (std::string module : std::vector<std::string>({"BOOT_CLOCK", "FCLK_BUF"})) {
+      uint32_t module_id = instances.find(module);
       i = 0;
-      for (auto& inst : instances_array) {
-        if (inst["module"] == module) {
-          if (inst["connectivity"].contains("O")) {
-            inst["linked_object"] = inst["connectivity"]["O"];
+      for (size_t inst = 0; inst < instances.size(); inst++) {
+        if (instances.module(inst) == module_id) {
+          size_t out = instances.find_connection(inst, instances.find("O"));
+          uint32_t object;
+          if (out == IO_INSTANCE_TABLE::NO_CONNECTION) {
+            object = instances.intern(stringf("%s#%ld", module.c_str(), i));
+          } else if (!instances.is_bus(out)) {
+            object = instances.net(out);
           } else {
-            inst["linked_object"] = stringf("%s#%ld", module.c_str(), i);
+            // The linked object is named after the single net of O
+            log_error("%s %s drives a bus from O\n", module.c_str(), instances.str(instances.name(inst)).c_str());
           }
-          inst["direction"] = "IN";
-          inst["index"] = 0;
+          instances.link(inst, object, instances.intern("IN"), 0);
           i++;
         }
       }
     }
     // Handle clock-data
-    link_instance_recursively(instances_array, 1, DATA_CLK_OUT_PORTS);
-    instances["instances"] = instances_array;
-    if (json_file.is_open()) {
-      json_file << std::setw(4) << instances << std::endl;
-      json_file.close();
+    net_index clock_nets;
+    index_instance_nets(instances, DATA_CLK_OUT_PORTS, clock_nets);
+    link_instance_recursively(instances, clock_nets, DATA_CLK_OUT_PORTS);
+  }
+
+  static bool write_io_config_json(const IO_INSTANCE_TABLE& instances, const std::string& file) {
+    std::ofstream json_file(file.c_str());
+    if (!json_file.is_open()) {
+      return false;
+    }
+    json_file << std::setw(4) << instances.to_json() << std::endl;
+    json_file.close();
+    return json_file.good();
+  }
+
+  // Instances connected to a net (by net ID), by the class of the port they
+  // connect it to: IN_PORTS (and PLL CLK_IN) or the OUT_PORTS of the linking
+  // step. Every list is in instance order
+  struct net_index {
+    std::vector<std::vector<size_t>> in_ports;
+    std::vector<std::vector<size_t>> out_ports;
+  };
+
+  void index_instance_nets(const IO_INSTANCE_TABLE& instances, const std::vector<std::string>& OUT_PORTS, net_index& nets) {
+    nets.in_ports.resize(instances.string_count());
+    nets.out_ports.resize(instances.string_count());
+    uint32_t pll = instances.find("PLL");
+    for (size_t i = 0; i < instances.size(); i++) {
+      for (size_t conn = instances.connection_begin(i); conn < instances.connection_end(i); conn++) {
+        if (instances.is_bus(conn)) {
+          continue;
+        }
+        uint32_t inst_net = instances.net(conn);
+        if (!PRIMITIVES_EXTRACTOR::is_real_net(instances.str(inst_net))) {
+          continue;
+        }
+        const std::string& port = instances.str(instances.port(conn));
+        std::vector<std::vector<size_t>*> lists;
+        if (std::find(IN_PORTS.begin(), IN_PORTS.end(), port) != IN_PORTS.end() ||
+            (instances.module(i) == pll && port == "CLK_IN")) {
+          lists.push_back(&nets.in_ports[inst_net]);
+        }
+        if (std::find(OUT_PORTS.begin(), OUT_PORTS.end(), port) != OUT_PORTS.end()) {
+          lists.push_back(&nets.out_ports[inst_net]);
+        }
+        for (auto list : lists) {
+          // An instance is linked once per net, whichever port matches
+          if (list->empty() || list->back() != i) {
+            list->push_back(i);
+          }
+        }
+      }
     }
   }
 
-#if 1
-  void link_instance_recursively(json& instances_array, int retry_start_index, const std::vector<std::string>& OUT_PORTS) {
-    log_assert(retry_start_index == 0 || retry_start_index == 1);
+  void link_instance_recursively(IO_INSTANCE_TABLE& instances, const net_index& nets, const std::vector<std::string>& OUT_PORTS) {
     // Compare to original link_instance_recursively() which had been commented out:
     //    This code does not need to specially handle I_BUF_DS and O_BUF_DS, O_BUFT_DS because
     //    netlist editor had removed the extra wire
-    while (true) {
-      // Recursively marks other primitives
-      size_t linked = 0;
-      for (auto& inst : instances_array) {
-        if (inst.contains("linked_object")) {
-          for (auto& iter : inst["connectivity"].items()) {
-            bool src_is_in = std::find(IN_PORTS.begin(), IN_PORTS.end(), (std::string)(iter.key())) != IN_PORTS.end();
-            bool src_is_out = std::find(OUT_PORTS.begin(), OUT_PORTS.end(), (std::string)(iter.key())) !=  OUT_PORTS.end();
-            if (src_is_in || src_is_out) {
-              log_assert((src_is_in & src_is_out) == false);
-              nlohmann::json signals = iter.value();
-              if (signals.is_string()) {
-                signals = nlohmann::json::array();
-                signals.push_back((std::string)(iter.value()));
+    // Every linked instance passes its object on once. The order is the one of
+    // sweeping the instances until nothing links anymore: an instance linked
+    // after the sweep went past it waits for the next sweep
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> sweep;
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> next_sweep;
+    for (size_t i = 0; i < instances.size(); i++) {
+      if (instances.is_linked(i)) {
+        sweep.push(i);
+      }
+    }
+    std::vector<size_t> linked_instances;
+    while (!sweep.empty()) {
+      size_t current = sweep.top();
+      sweep.pop();
+      for (size_t conn = instances.connection_begin(current); conn < instances.connection_end(current); conn++) {
+        const std::string& port = instances.str(instances.port(conn));
+        bool src_is_in = std::find(IN_PORTS.begin(), IN_PORTS.end(), port) != IN_PORTS.end();
+        bool src_is_out = std::find(OUT_PORTS.begin(), OUT_PORTS.end(), port) !=  OUT_PORTS.end();
+        if (src_is_in || src_is_out) {
+          log_assert((src_is_in & src_is_out) == false);
+          for (size_t s = 0; s < instances.net_count(conn); s++) {
+            uint32_t net = instances.net(conn, s);
+            if (!PRIMITIVES_EXTRACTOR::is_real_net(instances.str(net))) {
+              continue;
+            }
+            // dont set allow_dual_name=true, it might become infinite loop
+            linked_instances.clear();
+            link_instance(!src_is_in, instances, nets, instances.linked_object(current), net,
+                          instances.direction(current), instances.index(current) + 1, false, &linked_instances);
+            for (size_t linked : linked_instances) {
+              if (linked > current) {
+                sweep.push(linked);
               } else {
-                log_assert(signals.is_array());
-              }
-              for (auto& s : signals) {
-                std::string net = (std::string)(s);
-                if (!PRIMITIVES_EXTRACTOR::is_real_net(net)) {
-                  continue;
-                }
-                // dont set allow_dual_name=true, it might become infinite loop
-                linked += link_instance(!src_is_in, instances_array, inst["linked_object"], net, 
-                                        inst["direction"], uint32_t(inst["index"]) + 1, false, OUT_PORTS);
+                next_sweep.push(linked);
               }
             }
           }
         }
       }
-      if (linked == 0) {
-        // 1st time: we do not need recursive loop. One time is enough
-        // 2nd time: we need recursive until we cannot link anymore
-        break;
+      if (sweep.empty()) {
+        std::swap(sweep, next_sweep);
       }
     }
   }
-#else
-  void link_instance_recursively(json& instances_array, int retry_start_index, const std::vector<std::string>& OUT_PORTS) {
-    log_assert(retry_start_index == 0 || retry_start_index == 1);
-    // Special case for I_BUF_DS and O_BUF_DS, O_BUFT_DS, because they have multiple objects
-    // We need to loop this recursive loop twice
-    for (int i = retry_start_index; i < 2; i++) {
-      // first time : only link I_BUF_DS and O_BUF_DS, O_BUFT_DS (before they are used to link other instance)
-      //              because the name needs to be "p+n"
-      // second time: link the rest
-      while (true) {
-        // Recursively marks other primitives
-        size_t linked = 0;
-        for (auto& inst : instances_array) {
-          if (inst.contains("linked_object")) {
-            for (auto& iter : inst["connectivity"].items()) {
-              bool src_is_in = std::find(IN_PORTS.begin(), IN_PORTS.end(), (std::string)(iter.key())) != IN_PORTS.end();
-              bool src_is_out = std::find(OUT_PORTS.begin(), OUT_PORTS.end(), (std::string)(iter.key())) !=  OUT_PORTS.end();
-              if (src_is_in || src_is_out) {
-                log_assert((src_is_in & src_is_out) == false);
-                nlohmann::json signals = iter.value();
-                if (signals.is_string()) {
-                  signals = nlohmann::json::array();
-                  signals.push_back((std::string)(iter.value()));
-                } else {
-                  log_assert(signals.is_array());
-                }
-                for (auto& s : signals) {
-                  std::string net = (std::string)(s);
-                  if (!PRIMITIVES_EXTRACTOR::is_real_net(net)) {
-                    continue;
-                  }
-                  if (i == 0) {
-                    linked += link_instance(!src_is_in, instances_array, inst["linked_object"], net, 
-                                            inst["direction"], uint32_t(inst["index"]) + 1, true, OUT_PORTS,
-                                            {"I_BUF_DS", "O_BUF_DS", "O_BUFT_DS"});
-                  } else {
-                    // dont set allow_dual_name=true, it might become infinite loop
-                    linked += link_instance(!src_is_in, instances_array, inst["linked_object"], net, 
-                                            inst["direction"], uint32_t(inst["index"]) + 1, false, OUT_PORTS);
-                  }
-                }
-              }
-            }
-          }
-        }
-        if (i == 0 || linked == 0) {
-          // 1st time: we do not need recursive loop. One time is enough
-          // 2nd time: we need recursive until we cannot link anymore
-          break;
-        }
-      }
+
+  size_t link_instance(bool use_in_port, IO_INSTANCE_TABLE& instances, const net_index& nets, uint32_t object,
+                        uint32_t net, uint32_t direction, uint32_t index, bool allow_dual_name,
+                        std::vector<size_t>* linked_instances = nullptr) {
+    const auto& net_instances = use_in_port ? nets.in_ports : nets.out_ports;
+    if (net >= net_instances.size()) {
+      return 0;
     }
-  }
-#endif
-  
-  size_t link_instance(bool use_in_port, json& instances_array, const std::string& object, 
-                        const std::string& net, const std::string& direction, uint32_t index, bool allow_dual_name, 
-                        const std::vector<std::string>& OUT_PORTS, std::vector<std::string> search_modules = {}) {
     size_t linked = 0;
-    for (auto& inst : instances_array) {
+    for (size_t i : net_instances[net]) {
       // Only if this instance had not been linked
-      if (search_modules.size() > 0 &&
-          std::find(search_modules.begin(), search_modules.end(), inst["module"]) == search_modules.end()) {
+      if (!instances.is_linked(i)) {
+        instances.link(i, object, direction, index);
+      } else if (allow_dual_name) {
+        instances.link(i, instances.intern(stringf("%s+%s", instances.str(instances.linked_object(i)).c_str(),
+                                                   instances.str(object).c_str())), direction, index);
+      } else {
         continue;
       }
-      if (!inst.contains("linked_object") || allow_dual_name) {
-        for (auto& iter : inst["connectivity"].items()) {
-          if (!iter.value().is_string()) {
-            continue;
-          }
-          std::string inst_net = (std::string)(iter.value());
-          if (!PRIMITIVES_EXTRACTOR::is_real_net(inst_net)) {
-            continue;
-          }
-          bool match = false;
-          if (use_in_port && 
-              (std::find(IN_PORTS.begin(), IN_PORTS.end(), (std::string)(iter.key())) != IN_PORTS.end() || 
-               (inst["module"] == "PLL" && (std::string)(iter.key()) == "CLK_IN"))) {
-            match = true;
-          }
-          if (!use_in_port && 
-              (std::find(OUT_PORTS.begin(), OUT_PORTS.end(), (std::string)(iter.key())) !=  OUT_PORTS.end())) {
-            match = true;
-          }
-          if (match) {
-            if (inst_net == net) {
-              if (inst.contains("linked_object")) {
-                inst["linked_object"] = stringf("%s+%s", ((std::string)(inst["linked_object"])).c_str(), object.c_str());
-              } else {
-                inst["linked_object"] = object;
-              }
-              inst["direction"] = direction;
-              inst["index"] = index;
-              linked++;
-              break;
-            }
-          }
-        }
+      if (linked_instances) {
+        linked_instances->push_back(i);
       }
+      linked++;
     }
     return linked;
   }
@@ -2086,20 +2052,21 @@ struct DesignEditRapidSilicon : public ScriptPass {
       start = high_resolution_clock::now();
       log("Dumping config.json\n");
       // Dump entire wrap design using "config.json" naming (by default)
-      dump_io_config_json(wrapper_mod, io_config_json);
+      IO_INSTANCE_TABLE instances;
+      dump_io_config_json(wrapper_mod, instances);
+      // The file is only for the tools run after us, the SDC is written from
+      // the same instances while it is being written
+      std::future<bool> io_config_written = std::async(std::launch::async,
+          write_io_config_json, std::cref(instances), io_config_json);
       end = high_resolution_clock::now();
       elapsed_time (start, end);
       start = high_resolution_clock::now();
       log("Updating sdc\n");
-      std::ifstream input(io_config_json.c_str());
-      log_assert(input.is_open() && input.good());
-      nlohmann::json instances = nlohmann::json::parse(input);
-      input.close();
-      log_assert(instances.is_object());
-      log_assert(instances.contains("instances"));
-      extractor->write_sdc("design_edit.sdc", "clk_pin.xml", instances["instances"]);
+      extractor->write_sdc("design_edit.sdc", "clk_pin.xml", instances);
       std::string io_file = "io_" + io_config_json;
       extractor->write_json(io_file);
+      if (!io_config_written.get())
+        log_error("Cannot write %s\n", io_config_json.c_str());
       end = high_resolution_clock::now();
       elapsed_time (start, end);
       auto end_time = end;